@@ -6,6 +6,8 @@
 #include <string>
 
 #include <ftk/basic/union_find.hh>
+#include <ftk/basic/simple_union_find.hh>
+#include <ftk/basic/csr_graph.hh>
 #include <ftk/hypermesh/regular_simplex_mesh.hh>
 
 namespace ftk {
@@ -147,6 +149,33 @@ std::vector<std::set<IdType> > extract_connected_components(
   return extract_connected_components(neighbors, qualified);
 }
 
+// ================================================================
+// Extract connected components of a graph in the CSR format; each 
+// component is returned as an ascending list of node indices
+
+template <class IndexType>
+std::vector<std::vector<IndexType> > extract_connected_components(
+    const csr_graph<IndexType>& g)
+{
+  simple_union_find<IndexType> UF(g.n());
+  for (IndexType i = 0; i < g.n(); i ++)
+    for (auto p = g.neighbors_begin(i); p != g.neighbors_end(i); p ++)
+      if (*p < i) UF.unite(i, *p);
+
+  std::vector<IndexType> root_to_component(g.n(), g.n());
+  std::vector<std::vector<IndexType> > components;
+  for (IndexType i = 0; i < g.n(); i ++) {
+    const IndexType r = UF.find(i);
+    if (root_to_component[r] == g.n()) {
+      root_to_component[r] = components.size();
+      components.push_back(std::vector<IndexType>());
+    }
+    components[root_to_component[r]].push_back(i);
+  }
+
+  return components;
+}
+
 }
 
 #endif
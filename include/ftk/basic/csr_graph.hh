@@ -0,0 +1,44 @@
+#ifndef _FTK_CSR_GRAPH_HH
+#define _FTK_CSR_GRAPH_HH
+
+#include <vector>
+#include <algorithm>
+
+namespace ftk {
+
+// Adjacency of nodes [0, n) in compressed sparse row (CSR) format: the
+// neighbors of node i are adj[offsets[i]], ..., adj[offsets[i+1]-1].
+template <typename IndexType=size_t>
+struct csr_graph {
+  csr_graph() : offsets(1, 0) {}
+
+  size_t n() const {return offsets.size() - 1;}
+  size_t degree(IndexType i) const {return offsets[i+1] - offsets[i];}
+
+  const IndexType* neighbors_begin(IndexType i) const {return adj.data() + offsets[i];}
+  const IndexType* neighbors_end(IndexType i) const {return adj.data() + offsets[i+1];}
+
+  // Append the next node with the given neighbors; the neighbors are sorted
+  // and duplicates are removed.  Symmetry of the adjacency is up to the caller.
+  void add_node(std::vector<IndexType>& neighbors);
+
+  void clear() {offsets.assign(1, 0); adj.clear();}
+
+  std::vector<size_t> offsets;
+  std::vector<IndexType> adj;
+};
+
+/////
+template <typename IndexType>
+inline void csr_graph<IndexType>::add_node(std::vector<IndexType>& neighbors)
+{
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+  adj.insert(adj.end(), neighbors.begin(), neighbors.end());
+  offsets.push_back(adj.size());
+}
+
+}
+
+#endif
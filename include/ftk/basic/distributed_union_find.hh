@@ -113,32 +113,193 @@ private:
 
 }
 
+// ==========================================================
+
+enum {
+  MESSAGE_UNION_FIND_GID_QUERY, 
+  MESSAGE_UNION_FIND_GID_RESPONSE, 
+  MESSAGE_UNION_FIND_GPARENT_QUERY, 
+  MESSAGE_UNION_FIND_GPARENT, 
+  MESSAGE_UNION_FIND_ADD_TEMPORARY_ROOT, 
+  MESSAGE_UNION_FIND_ERASE_TEMPORARY_ROOT, 
+  MESSAGE_UNION_FIND_UNION, 
+  MESSAGE_UNION_FIND_ELE_PARENT_PAIR
+};
+
+// A message carries at most two element ids, a gid, and a flag; the meaning 
+// of the fields depends on the tag
+template <class IdType=std::string>
+struct Message_Union_Find_T {
+
+  Message_Union_Find_T() : tag(-1), ele(), related_ele(), gid(-1), is_known(false) {
+
+  }
+
+// Send message for query
+  void send_gid_query(const IdType& ele_) {
+    tag = MESSAGE_UNION_FIND_GID_QUERY; 
+    ele = ele_; 
+  }
+
+  void send_gid_response(const IdType& ele_, const int& gid_) {
+    tag = MESSAGE_UNION_FIND_GID_RESPONSE; 
+    ele = ele_; 
+    gid = gid_; 
+  }
+
+  void send_gparent_query(const IdType& child, const IdType& parent, const int& gid_child) {
+    tag = MESSAGE_UNION_FIND_GPARENT_QUERY;
+    ele = child; 
+    related_ele = parent; 
+    gid = gid_child; 
+  }
+
+  void send_gparent(const IdType& ele_, const IdType& gparent, const int& gid_gparent, const bool& is_known_) {
+    tag = MESSAGE_UNION_FIND_GPARENT;
+    ele = ele_; 
+    related_ele = gparent; 
+    gid = gid_gparent; 
+    is_known = is_known_; 
+  }
+
+  void send_add_temporary_root(const IdType& parent) {
+    tag = MESSAGE_UNION_FIND_ADD_TEMPORARY_ROOT;
+    ele = parent; 
+  }
+
+  void send_erase_temporary_root(const IdType& parent, const IdType& grandparent, const int& gid_grandparent, const bool& is_known_) {
+    tag = MESSAGE_UNION_FIND_ERASE_TEMPORARY_ROOT;
+    ele = parent; 
+    related_ele = grandparent; 
+    gid = gid_grandparent; 
+    is_known = is_known_; 
+  }
+
+  // Send the union (ele, related_ele) to ele
+  void send_union(const IdType& ele_, const IdType& related_ele_, const int& gid_related_ele) {
+    tag = MESSAGE_UNION_FIND_UNION; 
+    ele = ele_; 
+    related_ele = related_ele_; 
+    gid = gid_related_ele; 
+  }
+
+  void send_ele_parent_pair(const std::pair<IdType, IdType>& pair) {
+    tag = MESSAGE_UNION_FIND_ELE_PARENT_PAIR; 
+    ele = pair.first; 
+    related_ele = pair.second; 
+  }
+
+// Receive message
+
+  void rec_gid_query(IdType& ele_) const {
+    ele_ = ele; 
+  }
+
+  void rec_gid_response(IdType& ele_, int& gid_) const {
+    ele_ = ele; 
+    gid_ = gid; 
+  }
+
+  void rec_gparent_query(IdType& child, IdType& parent, int& gid_child) const {
+    child = ele; 
+    parent = related_ele; 
+    gid_child = gid; 
+  }
+
+  void rec_gparent(IdType& ele_, IdType& gparent, int& gid_gparent, bool& is_known_) const {
+    ele_ = ele; 
+    gparent = related_ele;
+    gid_gparent = gid; 
+    is_known_ = is_known; 
+  }
+
+  void rec_add_temporary_root(IdType& parent) const {
+    parent = ele;
+  }
+
+  void rec_erase_temporary_root(IdType& parent, IdType& grandparent, int& gid_grandparent, bool& is_known_) const {
+    parent = ele;
+    grandparent = related_ele; 
+    gid_grandparent = gid; 
+    is_known_ = is_known; 
+  }
+
+  void rec_union(IdType& ele_, IdType& related_ele_, int& rgid) const {
+    ele_ = ele; 
+    related_ele_ = related_ele; 
+    rgid = gid; 
+  }
+
+  void receive_ele_parent_pair(std::pair<IdType, IdType>& pair) const {
+    pair = std::make_pair(ele, related_ele); 
+  }
+
+public:
+  int tag; 
+
+  IdType ele, related_ele; 
+  int gid; 
+  bool is_known; 
+}; 
+
+typedef Message_Union_Find_T<std::string> Message_Union_Find;
+
+// ==========================================================
+
+namespace diy
+{
+    template<class IdType>
+        struct Serialization<Message_Union_Find_T<IdType>>
+    {
+        static void save(BinaryBuffer& bb, const Message_Union_Find_T<IdType>& msg)
+        {
+            diy::save(bb, msg.tag);
+            diy::save(bb, msg.ele);
+            diy::save(bb, msg.related_ele);
+            diy::save(bb, msg.gid);
+            diy::save(bb, msg.is_known);
+        }
+
+        static void load(BinaryBuffer& bb, Message_Union_Find_T<IdType>& msg)
+        {
+            diy::load(bb, msg.tag);
+            diy::load(bb, msg.ele);
+            diy::load(bb, msg.related_ele);
+            diy::load(bb, msg.gid);
+            diy::load(bb, msg.is_known);
+        }
+    };
+}
+
 // DIY Block for distributed union-find
-struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
-  Block_Union_Find(): nchanges(0), related_elements(), all_related_elements(), temporary_root_2_gids(), nonlocal_temporary_roots_2_grandparents(), ele2gid(), distributed_union_find() { 
+template <class IdType=std::string>
+struct Block_Union_Find_T : public ftk::distributed_union_find<IdType> {
+  typedef ftk::distributed_union_find<IdType> distributed_union_find;
+
+  Block_Union_Find_T(): distributed_union_find(), ele2gid(), nchanges(0), temporary_root_2_gids(), nonlocal_temporary_roots_2_grandparents(), related_elements(), all_related_elements() { 
     
   }
 
   // add an element
-  void add(std::string ele) {
+  void add(IdType ele) {
     this->nchanges += 1;
 
     if(this->has(ele)) {
       std::cout<<"This ele has been added. "<<ele<<std::endl; 
     } else {
       distributed_union_find::add(ele); 
-      this->related_elements.insert(std::make_pair(ele, std::set<std::string>())); 
+      this->related_elements.insert(std::make_pair(ele, std::set<IdType>())); 
       this->has_sent_gparent_query[ele] = false;
     }
   }
 
-  void erase_element(std::string ele) {
+  void erase_element(IdType ele) {
     this->nchanges += 1;
 
     this->eles.erase(ele);
   }
 
-  bool has_related_element(std::string ele, std::string related_ele) {
+  bool has_related_element(IdType ele, IdType related_ele) {
     assert(this->has(ele)); 
 
     if(this->related_elements[ele].find(related_ele) == this->related_elements[ele].end()) {
@@ -148,7 +309,7 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
     return true; 
   }
 
-  void add_related_element(std::string ele, std::string related_ele) {
+  void add_related_element(IdType ele, IdType related_ele) {
     this->nchanges += 1;
 
     // std::cout<<"Add union: "<<ele<<"-"<<related_ele<<std::endl; 
@@ -169,13 +330,13 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
 
   }
 
-  const std::set<std::string>& get_related_elements(std::string ele) {
+  const std::set<IdType>& get_related_elements(IdType ele) {
     assert(this->has(ele)); 
     
     return this->related_elements[ele]; 
   }
 
-  void clear_related_elements(std::string ele) {
+  void clear_related_elements(IdType ele) {
     this->nchanges += 1;
 
     assert(this->has(ele)); 
@@ -183,7 +344,7 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
     this->related_elements[ele].clear(); 
   }
 
-  void erase_related_element(std::string ele, std::string related_element) {
+  void erase_related_element(IdType ele, IdType related_element) {
     this->nchanges += 1;
 
     assert(this->has(ele)); 
@@ -191,7 +352,7 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
     this->related_elements[ele].erase(related_element); 
   }
 
-  bool has_gid(std::string ele) {
+  bool has_gid(IdType ele) {
     if(this->ele2gid.find(ele) == this->ele2gid.end()) {
       return false; 
     }
@@ -199,7 +360,7 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
     return true; 
   }
 
-  void set_gid(std::string ele, int gid) {
+  void set_gid(IdType ele, int gid) {
     this->nchanges += 1;
 
     if(gid >= 0) {
@@ -207,31 +368,31 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
     }
   }
 
-  int get_gid(std::string ele) {
+  int get_gid(IdType ele) {
     assert(this->has_gid(ele)); 
 
     return this->ele2gid[ele]; 
   }
 
-  void set_parent(std::string i, std::string par) {
+  void set_parent(IdType i, IdType par) {
     this->nchanges += 1;
 
     distributed_union_find::set_parent(i, par); 
   }
 
-  void add_nonlocal_temporary_root(std::string temporary_root) {
+  void add_nonlocal_temporary_root(IdType temporary_root) {
     this->nchanges += 1;
 
     distributed_union_find::add_nonlocal_temporary_root(temporary_root); 
   }
 
-  void erase_nonlocal_temporary_root(std::string temporary_root) {
+  void erase_nonlocal_temporary_root(IdType temporary_root) {
     this->nchanges += 1;
 
     distributed_union_find::erase_nonlocal_temporary_root(temporary_root); 
   }
 
-  bool is_temporary_root(std::string i) {
+  bool is_temporary_root(IdType i) {
     if(this->has(i)) {
       // if(this->is_root(i) && this->get_related_elements(i).size() == 0) {
       if(this->is_root(i)) {
@@ -247,11 +408,26 @@ struct Block_Union_Find : public ftk::distributed_union_find<std::string> {
   }
 
 
-  void get_sets(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<std::set<std::string>>& results);
+  void get_sets(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<std::set<IdType>>& results);
+
+  // Messages are buffered per destination block and sent in batches
+  void enqueue(int gid, const Message_Union_Find_T<IdType>& msg) {
+    outgoing_messages[gid].push_back(msg); 
+  }
+
+  void flush_messages(const diy::Master::ProxyWithLink& cp) {
+    diy::Link* l = cp.link();
+    for(auto& pair : outgoing_messages) {
+      if(pair.second.size() > 0) {
+        cp.enqueue(l->target(l->find(pair.first)), pair.second); 
+        pair.second.clear(); 
+      }
+    }
+  }
 
 public: 
 
-  std::map<std::string, int> ele2gid; 
+  std::map<IdType, int> ele2gid; 
 
   int nchanges = 0; // # of processed unions per round = valid unions (united unions) + passing unions
 
@@ -260,194 +436,30 @@ public:
     double time_final_update_start;
   #endif
   
-  // std::map<int, std::set<std::string>> cache_send_temporary_roots ;
+  // std::map<int, std::set<IdType>> cache_send_temporary_roots ;
 
-  std::map<std::string, std::set<int>> temporary_root_2_gids; 
+  std::map<IdType, std::set<int>> temporary_root_2_gids; 
 
-  std::map<std::string, std::string> nonlocal_temporary_roots_2_grandparents; 
+  std::map<IdType, IdType> nonlocal_temporary_roots_2_grandparents; 
 
-  std::map<std::string, bool> has_sent_gparent_query; 
+  std::map<IdType, bool> has_sent_gparent_query; 
+
+  std::map<int, std::vector<Message_Union_Find_T<IdType>>> outgoing_messages; 
 
 private:
   // map element id to ids of its related elements
   // Can be optimized by ordered the related elements, put related elements on process first and ordered decreingly by ids
   
-  std::map<std::string, std::set<std::string>> related_elements; 
-  std::map<std::string, std::set<std::string>> all_related_elements;   
+  std::map<IdType, std::set<IdType>> related_elements; 
+  std::map<IdType, std::set<IdType>> all_related_elements;   
 };
 
-// ==========================================================
-
-struct Message_Union_Find {
-
-  Message_Union_Find() : tag(), strs() {
-
-  }
-
-// Send message for query
-  void send_gid_query(std::string& ele) {
-    tag = "gid_query"; 
-    strs.push_back(ele);  
-  }
-
-  void send_gid_response(std::string& ele, int& gid) {
-    tag = "gid_response"; 
-
-    strs.push_back(ele); 
-    strs.push_back(std::to_string(gid)); 
-  }
-
-  void send_gparent_query(const std::string& child, const std::string& parent, const int& gid_child) {
-    tag = "gparent_query";
-
-    strs.push_back(child); 
-    strs.push_back(parent); 
-    strs.push_back(std::to_string(gid_child)); 
-  }
-
-  void send_gparent(std::string& ele, std::string& gparent, int& gid_gparent, bool& is_known) {
-    tag = "gparent";
-
-    strs.push_back(ele); 
-    strs.push_back(gparent); 
-    strs.push_back(std::to_string(gid_gparent)); 
-    strs.push_back(std::to_string(is_known)); 
-  }
-
-  void send_add_temporary_root(const std::string& parent) {
-    tag = "add_temporary_root";
-
-    strs.push_back(parent); 
-  }
-
-  void send_erase_temporary_root(const std::string& parent, const std::string& grandparent, const int& gid_grandparent, const bool& is_known ) {
-    tag = "erase_temporary_root";
-
-    strs.push_back(parent); 
-    strs.push_back(grandparent); 
-    strs.push_back(std::to_string(gid_grandparent)); 
-    strs.push_back(std::to_string(is_known)); 
-  }
-
-  // Send the union (ele, related_ele) to ele
-  void send_union(const std::string& ele, const std::string& related_ele, const int& gid_related_ele) {
-    tag = "union"; 
-
-    strs.push_back(ele); 
-    strs.push_back(related_ele); 
-    strs.push_back(std::to_string(gid_related_ele)); 
-  }
-
-  void send_ele_parent_pair(std::pair<std::string, std::string>& pair) {
-    tag = "ele_parent_pair"; 
-
-    strs.push_back(pair.first); 
-    strs.push_back(pair.second); 
-  }
-
-  void send_ele_parent_pairs(std::vector<std::pair<std::string, std::string>>& pairs) {
-    tag = "ele_parent_pairs"; 
-
-    for(auto& pair : pairs) {
-      strs.push_back(pair.first); 
-      strs.push_back(pair.second); 
-    }
-  }
-
-// Receive message
-
-  void rec_gid_query(std::string& ele) {
-    ele = strs[0]; 
-  }
-
-  void rec_gid_response(std::string& ele, int& gid) {
-    ele = strs[0]; 
-    gid = std::stoi(strs[1]);  
-  }
-
-  void rec_gparent_query(std::string& child, std::string& parent, int& gid_child) {
-    child = strs[0]; 
-    parent = strs[1]; 
-    gid_child = std::stoi(strs[2]);  
-  }
-
-  void rec_gparent(std::string& ele, std::string& gparent, int& gid_gparent, bool& is_known) {
-    ele = strs[0]; 
-    gparent = strs[1];
-
-    gid_gparent = std::stoi(strs[2]); 
-    is_known = std::stoi(strs[3]); 
-  }
-
-  void rec_child(std::string& parent, std::string& child, int& gid_child, bool& is_known) {
-    parent = strs[0]; 
-    child = strs[1];
-
-    gid_child = std::stoi(strs[2]); 
-    is_known = std::stoi(strs[3]); 
-  }
-
-  void rec_add_temporary_root(std::string& parent) {
-    parent = strs[0];
-  }
-
-  void rec_erase_temporary_root(std::string& parent, std::string& grandparent, int& gid_grandparent, bool& is_known) {
-    parent = strs[0];
-
-    grandparent = strs[1]; 
-    gid_grandparent = std::stoi(strs[2]); 
-    is_known = std::stoi(strs[3]); 
-  }
-
-  void rec_union(std::string& ele, std::string& related_ele, int& rgid) {
-    ele = strs[0]; 
-    related_ele = strs[1]; 
-
-    rgid = std::stoi(strs[2]); 
-  }
-
-  void receive_ele_parent_pair(std::pair<std::string, std::string>& pair) {
-    pair = std::make_pair(strs[0], strs[1]); 
-  }
-
-  void receive_ele_parent_pairs(std::vector<std::pair<std::string, std::string>>& pairs) {
-    for(int i = 0; i < strs.size(); i += 2) {
-      pairs.push_back(std::make_pair(strs[i], strs[i+1]));
-    }
-  }
-
-public:
-  std::string tag; 
-
-  std::vector<std::string> strs; 
-}; 
-
-// ==========================================================
-
-namespace diy
-{
-    template<>
-        struct Serialization<Message_Union_Find>
-    {
-        static void save(BinaryBuffer& bb, const Message_Union_Find& msg)
-        {
-            diy::save(bb, msg.tag);
-            // diy::save(bb, msg.str);
-            diy::save(bb, msg.strs);
-        }
-
-        static void load(BinaryBuffer& bb, Message_Union_Find& msg)
-        {
-            diy::load(bb, msg.tag);
-            // diy::load(bb, msg.str);
-            diy::load(bb, msg.strs);
-        }
-    };
-}
+typedef Block_Union_Find_T<std::string> Block_Union_Find;
 
 // ==========================================================
 
-void import_data(std::vector<Block_Union_Find*>& blocks, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<int>& gids) {
+template <class IdType>
+inline void import_data(std::vector<Block_Union_Find_T<IdType>*>& blocks, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<int>& gids) {
   // for the local blocks in this processor
   for (unsigned i = 0; i < gids.size(); ++i) {
     int gid = gids[i];
@@ -464,13 +476,14 @@ void import_data(std::vector<Block_Union_Find*>& blocks, diy::Master& master, di
       }
     }
 
-    Block_Union_Find* b = blocks[i]; 
+    Block_Union_Find_T<IdType>* b = blocks[i]; 
     master.add(gid, b, link); 
     // master.replace_link(0, link);
   }
 }
 
-void query_gid(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void query_gid(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   int gid = cp.gid(); 
   diy::Link* l = cp.link();
 
@@ -483,56 +496,58 @@ void query_gid(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
       // std::cout<<"A gid is missing: " << it->first<<std::endl; 
 
-      std::string ele = it->first; 
+      IdType ele = it->first; 
       if(b->has(ele)) {
         it->second = gid; 
       } else {
         for (int i = 0; i < l->size(); ++i) {
-          Message_Union_Find msg = Message_Union_Find(); 
+          Message_Union_Find_T<IdType> msg; 
           msg.send_gid_query(ele); 
 
-          cp.enqueue(l->target(i), msg);
+          b->enqueue(l->target(i).gid, msg);
         }
       }
 
     }
   }
 
+  b->flush_messages(cp); 
+
   // std::cout<<std::endl; 
 }
 
 
-void answer_gid(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg, int from_gid) {
+template <class IdType>
+inline void answer_gid(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg, int from_gid) {
   int gid = cp.gid(); 
-  diy::Link* l = cp.link();
   // diy::Master* master = cp.master(); 
 
   // std::cout<<"Answer: "<<std::endl; 
   // std::cout<<"Block ID: "<<gid<<std::endl; 
 
-  std::string ele; 
+  IdType ele; 
   msg.rec_gid_query(ele); 
 
   if(b->has(ele)) {
-    Message_Union_Find send_msg; 
+    Message_Union_Find_T<IdType> send_msg; 
     send_msg.send_gid_response(ele, gid); 
 
     // std::cout<<ele<<"-";
     // std::cout<<gid;
     // std::cout<<std::endl; 
 
-    cp.enqueue(l->target(l->find(from_gid)), send_msg);
-    // cp.enqueue(l->target(l->find(in[i])), 1);
+    b->enqueue(from_gid, send_msg);
   }
 
   // std::cout<<std::endl; 
 }
 
-void save_gid(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
+template <class IdType>
+inline void save_gid(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
   // std::cout<<"Save: "<<std::endl; 
   // std::cout<<"Block ID: "<<gid<<std::endl; 
 
-  std::string ele; 
+  IdType ele; 
   int gid_ele; 
   msg.rec_gid_response(ele, gid_ele); 
 
@@ -550,14 +565,14 @@ void save_gid(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message
 }
 
 
-void send_erase_temporary_root_to_all_processes(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, const std::string& parent, const std::string& grandparent, const int& gid_grandparent, const bool& is_known) {
+template <class IdType>
+inline void send_erase_temporary_root_to_all_processes(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const IdType& parent, const IdType& grandparent, const int& gid_grandparent, const bool& is_known) {
     
     if(b->temporary_root_2_gids.find(parent) != b->temporary_root_2_gids.end()) {
-      diy::Link* l = cp.link();
       for(auto& gid : b->temporary_root_2_gids[parent]) {
-        Message_Union_Find send_msg; 
+        Message_Union_Find_T<IdType> send_msg; 
         send_msg.send_erase_temporary_root(parent, grandparent, gid_grandparent, is_known); // Erase an temporary root to the process of child
-        cp.enqueue(l->target(l->find(gid)), send_msg); 
+        b->enqueue(gid, send_msg); 
 
         if(is_known) {
           b->temporary_root_2_gids[grandparent].insert(gid); 
@@ -570,9 +585,8 @@ void send_erase_temporary_root_to_all_processes(Block_Union_Find* b, const diy::
 }
 
 
-void unite_once(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
-  int gid = cp.gid(); 
-  diy::Link* l = cp.link();
+template <class IdType>
+inline void unite_once(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
 
   for(auto& ele : b->eles) {
 
@@ -581,7 +595,7 @@ void unite_once(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
       // If having an assign_global_roots
       auto& related_elements = b->get_related_elements(ele); 
       // cannot use auto&, since we will remove some elements from the original set; auto& will cause segmentation erro
-      std::string found_related_ele = ele; // Find a smallest related element has a smaller id than ele
+      IdType found_related_ele = ele; // Find a smallest related element has a smaller id than ele
       // Find from local related elements
       for(auto& related_ele : related_elements) {
         if(b->has(related_ele)) {
@@ -605,7 +619,7 @@ void unite_once(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
       // ================================================================
 
       // auto& related_elements = b->get_related_elements(ele); 
-      // std::string found_related_ele = ele; // Find a smallest related element has a smaller id than ele
+      // IdType found_related_ele = ele; // Find a smallest related element has a smaller id than ele
       // for(auto& related_ele : related_elements) {
         
       //   if(!b->has_gid(related_ele)) {
@@ -646,16 +660,16 @@ void unite_once(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 }
 
 
-void compress_path(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void compress_path(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   int gid = cp.gid(); 
-  diy::Link* l = cp.link();
 
   if(b->nonlocal_temporary_roots_2_grandparents.size() > 0) {
     for(auto& ele : b->eles) {
       if(!b->is_root(ele)) {
-        std::string parent = b->parent(ele);
+        IdType parent = b->parent(ele);
         if(b->nonlocal_temporary_roots_2_grandparents.find(parent) != b->nonlocal_temporary_roots_2_grandparents.end()) {
-          std::string grandparent = b->nonlocal_temporary_roots_2_grandparents[parent]; 
+          IdType grandparent = b->nonlocal_temporary_roots_2_grandparents[parent]; 
           b->set_parent(ele, grandparent); 
         }
       }
@@ -666,12 +680,12 @@ void compress_path(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
   for(auto& ele : b->eles) {
 
     if(!b->is_root(ele)) {
-      std::string parent = b->parent(ele);
+      IdType parent = b->parent(ele);
 
       if(b->has(parent)) {
         
         if(!b->is_root(parent)) {
-          std::string grandparent = b->parent(parent);
+          IdType grandparent = b->parent(parent);
 
           if(b->has(grandparent)) { // If having an assign_global_roots
             b->set_parent(ele, grandparent);    
@@ -696,10 +710,10 @@ void compress_path(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
           if(b->has_gid(parent)) {
             int gid_parent = b->get_gid(parent);
 
-            Message_Union_Find send_msg; 
+            Message_Union_Find_T<IdType> send_msg; 
             
             send_msg.send_gparent_query(ele, parent, gid); 
-            cp.enqueue(l->target(l->find(gid_parent)), send_msg); 
+            b->enqueue(gid_parent, send_msg); 
 
             b->has_sent_gparent_query[ele] = true;
           }
@@ -712,9 +726,10 @@ void compress_path(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
 
 // Distributed path compression - Step Two
-void distributed_save_gparent(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
-  std::string ele; 
-  std::string grandpar; 
+template <class IdType>
+inline void distributed_save_gparent(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
+  IdType ele; 
+  IdType grandpar; 
   int gid_grandparent; 
   bool is_known; 
 
@@ -740,22 +755,22 @@ void distributed_save_gparent(Block_Union_Find* b, const diy::Master::ProxyWithL
 }
 
 // Distributed path compression - Step Three
-void distributed_answer_gparent_query(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
-  diy::Link* l = cp.link();
+template <class IdType>
+inline void distributed_answer_gparent_query(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
 
-  std::string child; 
-  std::string parent; 
+  IdType child; 
+  IdType parent; 
   int gid_child; 
 
   msg.rec_gparent_query(child, parent, gid_child); 
 
   b->set_gid(child, gid_child);
 
-  std::string grandparent = b->parent(parent); 
+  IdType grandparent = b->parent(parent); 
   int gid_grandparent = b->get_gid(grandparent);
 
   // Set child's parent to grandparent
-  Message_Union_Find send_msg; 
+  Message_Union_Find_T<IdType> send_msg; 
   bool is_known = b->is_temporary_root(grandparent); 
 
   if(is_known) {
@@ -763,20 +778,22 @@ void distributed_answer_gparent_query(Block_Union_Find* b, const diy::Master::Pr
   }
 
   send_msg.send_gparent(child, grandparent, gid_grandparent, is_known); 
-  cp.enqueue(l->target(l->find(gid_child)), send_msg); 
+  b->enqueue(gid_child, send_msg); 
 }
 
 // Receive adding an temporary root
-void distributed_add_temporary_root(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
-  std::string par;
+template <class IdType>
+inline void distributed_add_temporary_root(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
+  IdType par;
   msg.rec_add_temporary_root(par); // Add an temporary root
 
   b->add_nonlocal_temporary_root(par); 
 }
 
-void distributed_erase_temporary_root (Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
-  std::string parent;
-  std::string grandparent;
+template <class IdType>
+inline void distributed_erase_temporary_root(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
+  IdType parent;
+  IdType grandparent;
   int gid_grandparent; 
   bool is_known;
   msg.rec_erase_temporary_root(parent, grandparent, gid_grandparent, is_known); // Erase an temporary root, and if some elements' parents are this temporary root before, we replace with the grandparent
@@ -794,9 +811,9 @@ void distributed_erase_temporary_root (Block_Union_Find* b, const diy::Master::P
 }
 
 
-void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void pass_unions(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   int gid = cp.gid(); 
-  diy::Link* l = cp.link();
 
   // Local computation
   // Pass unions of elements in this block to their parents, save these unions
@@ -806,7 +823,7 @@ void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
       auto& src = b->get_related_elements(ele);
       if(src.size() > 0) {
-        std::string par = b->parent(ele);
+        IdType par = b->parent(ele);
 
         // if(!b->is_temporary_root(par)) { // Previously test best
         //   continue ;
@@ -830,7 +847,7 @@ void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
           continue ;
         }
 
-        std::vector<std::string> cache;
+        std::vector<IdType> cache;
         for(auto& related_ele : src) {
 
           if(related_ele < par) {
@@ -849,10 +866,10 @@ void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
               int r_gid = b->get_gid(related_ele); 
 
-              Message_Union_Find send_msg; 
+              Message_Union_Find_T<IdType> send_msg; 
               send_msg.send_union(par, related_ele, r_gid); 
 
-              cp.enqueue(l->target(l->find(p_gid)), send_msg); 
+              b->enqueue(p_gid, send_msg); 
 
             }
 
@@ -870,10 +887,10 @@ void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
               int r_gid = b->get_gid(related_ele); 
 
-              Message_Union_Find send_msg; 
+              Message_Union_Find_T<IdType> send_msg; 
               send_msg.send_union(related_ele, par, p_gid); 
 
-              cp.enqueue(l->target(l->find(r_gid)), send_msg); 
+              b->enqueue(r_gid, send_msg); 
             }
 
           }
@@ -897,14 +914,14 @@ void pass_unions(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
 
 // Update unions of related elements
-void distributed_save_union(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg) {
-  diy::Link* l = cp.link();
+template <class IdType>
+inline void distributed_save_union(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg) {
 
   // std::cout<<"Save Unions: "<<std::endl; 
   // std::cout<<"Block ID: "<<cp.gid()<<std::endl; 
 
-  std::string ele; 
-  std::string related_ele; 
+  IdType ele; 
+  IdType related_ele; 
   int rgid; 
   
   msg.rec_union(ele, related_ele, rgid); 
@@ -919,7 +936,8 @@ void distributed_save_union(Block_Union_Find* b, const diy::Master::ProxyWithLin
   // std::cout<<std::endl; 
 }
 
-void local_computation(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void local_computation(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
 
   #if ISDEBUG
     int gid = cp.gid();
@@ -954,7 +972,7 @@ void local_computation(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp
   //     if(pair.second.size() > 0) {
   //       auto& target = l->target(l->find(pair.first)); 
   //       for(auto& par : pair.second) {
-  //         Message_Union_Find send_msg; 
+  //         Message_Union_Find_T<IdType> send_msg; 
   //         send_msg.send_add_temporary_root(par); // Add an temporary root to the process of child
 
   //         cp.enqueue(target, send_msg);   
@@ -965,10 +983,12 @@ void local_computation(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp
   //   b->cache_send_temporary_roots.clear(); 
   // }
 
+  b->flush_messages(cp); 
 }
 
 
-void received_msg(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Message_Union_Find msg, int from_gid) {
+template <class IdType>
+inline void received_msg(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp, const Message_Union_Find_T<IdType>& msg, int from_gid) {
   // std::cout<<msg.tag<<std::endl; 
 
   // if(msg.tag == "gid_query") {
@@ -981,28 +1001,27 @@ void received_msg(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp, Mes
     std::cout<<"Start Receiving Msg: "<<msg.tag<<std::endl; 
   #endif
 
-  if(msg.tag == "gparent") {
+  if(msg.tag == MESSAGE_UNION_FIND_GPARENT) {
     distributed_save_gparent(b, cp, msg); 
-  } else if(msg.tag == "gparent_query") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_GPARENT_QUERY) {
     distributed_answer_gparent_query(b, cp, msg); 
-  } else if(msg.tag == "add_temporary_root") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_ADD_TEMPORARY_ROOT) {
     distributed_add_temporary_root(b, cp, msg);
-  } else if(msg.tag == "erase_temporary_root") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_ERASE_TEMPORARY_ROOT) {
     distributed_erase_temporary_root(b, cp, msg);
-  } else if(msg.tag == "union") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_UNION) {
     distributed_save_union(b, cp, msg); 
-  } else if(msg.tag == "gid_query") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_GID_QUERY) {
     answer_gid(b, cp, msg, from_gid); 
-  } else if(msg.tag == "gid_response") {
+  } else if(msg.tag == MESSAGE_UNION_FIND_GID_RESPONSE) {
     save_gid(b, cp, msg); 
   } else {
     std::cout<<"Error! "<<std::endl; 
   }
 }
 
-void receive_msg(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
-  int gid = cp.gid(); 
-  diy::Link* l = cp.link();
+template <class IdType>
+inline void receive_msg(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   
   while(!cp.empty_incoming_queues()) {
     std::vector<int> in;
@@ -1010,16 +1029,19 @@ void receive_msg(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
 
     for (unsigned i = 0; i < in.size(); ++i) {
       if(cp.incoming(in[i])) {
-        Message_Union_Find msg; 
-        cp.dequeue(in[i], msg);
+        std::vector<Message_Union_Find_T<IdType>> msgs; 
+        cp.dequeue(in[i], msgs);
 
-        received_msg(b, cp, msg, in[i]); 
+        for(auto& msg : msgs) {
+          received_msg(b, cp, msg, in[i]); 
+        }
       }
     }
   }
 }
 
-bool union_find_iexchange(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline bool union_find_iexchange(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   b->nchanges = 0; 
   
   receive_msg(b, cp); 
@@ -1037,18 +1059,19 @@ bool union_find_iexchange(Block_Union_Find* b, const diy::Master::ProxyWithLink&
   return b->nchanges == 0; 
 }
 
-void assign_global_roots(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void assign_global_roots(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   #if OUTPUT_TIME_EACH_ROUND
     b->time_final_update_start = MPI_Wtime();
   #endif
   for(auto& ele : b->eles) {
 
     if(!b->is_root(ele)) {
-      std::string parent = b->parent(ele);
+      IdType parent = b->parent(ele);
 
       if(b->has(parent)) {
         if(!b->is_root(parent)) {
-          std::string grandparent = b->parent(parent);
+          IdType grandparent = b->parent(parent);
 
           b->set_parent(ele, grandparent);
         }
@@ -1058,12 +1081,14 @@ void assign_global_roots(Block_Union_Find* b, const diy::Master::ProxyWithLink&
 }
 
 
-void iexchange_process(diy::Master& master) {
-  master.iexchange(&union_find_iexchange); 
-  master.foreach(&assign_global_roots); 
+template <class IdType>
+inline void iexchange_process(diy::Master& master) {
+  master.iexchange(&union_find_iexchange<IdType>); 
+  master.foreach(&assign_global_roots<IdType>); 
 }
 
-void total_changes(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void total_changes(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   cp.collectives()->clear();
 
   cp.all_reduce(b->nchanges, std::plus<int>()); 
@@ -1074,10 +1099,11 @@ void total_changes(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
   #endif
 }
 
-void exchange_process(diy::Master& master) {
-  master.foreach(&receive_msg);
-  master.foreach(&local_computation);
-  master.foreach(&total_changes);
+template <class IdType>
+inline void exchange_process(diy::Master& master) {
+  master.foreach(&receive_msg<IdType>);
+  master.foreach(&local_computation<IdType>);
+  master.foreach(&total_changes<IdType>);
   
   // master.exchange();
 
@@ -1086,7 +1112,8 @@ void exchange_process(diy::Master& master) {
   #endif
 }
 
-void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<Block_Union_Find*>& blocks, bool is_iexchange = true, std::string filename_time_uf_w="") {
+template <class IdType>
+inline void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<Block_Union_Find_T<IdType>*>& blocks, bool is_iexchange = true, std::string filename_time_uf_w="") {
 
   std::vector<int> gids;                     // global ids of local blocks
   assigner.local_gids(world.rank(), gids);   // get the gids of local blocks for a given process rank 
@@ -1104,8 +1131,8 @@ void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& mas
   #endif
 
   if(is_iexchange) { // for iexchange
-    master.foreach(&query_gid);
-    iexchange_process(master);  
+    master.foreach(&query_gid<IdType>);
+    iexchange_process<IdType>(master);  
 
     // =========================================
     // Debug and Print
@@ -1139,7 +1166,7 @@ void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& mas
   } else { // for exchange
     bool all_done = false;
 
-    master.foreach(&query_gid);
+    master.foreach(&query_gid<IdType>);
     master.exchange();
 
     #if OUTPUT_TIME_EACH_ROUND
@@ -1147,7 +1174,7 @@ void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& mas
     #endif
 
     while(!all_done) {
-      exchange_process(master); 
+      exchange_process<IdType>(master); 
 
       #if OUTPUT_TIME_EACH_ROUND
         #ifdef FTK_HAVE_MPI
@@ -1191,7 +1218,7 @@ void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& mas
       #endif
     #endif
 
-    // master.foreach(&assign_global_roots); 
+    // master.foreach(&assign_global_roots<IdType>); 
     // #if OUTPUT_TIME_EACH_ROUND
     //   #ifdef FTK_HAVE_MPI
     //     double time_final_update_end = MPI_Wtime(); 
@@ -1235,7 +1262,7 @@ void exec_distributed_union_find(diy::mpi::communicator& world, diy::Master& mas
 
 // =================================================
 
-int hash_string(std::string& ele, size_t nprocess) {
+inline int hash_string(const std::string& ele, size_t nprocess) {
   // Algorithms come from: https://cp-algorithms.com/string/string-hashing.html
   
   const int p = 11; // since the characters are 0~9 plus ',' for separation
@@ -1255,12 +1282,25 @@ int hash_string(std::string& ele, size_t nprocess) {
   return val; 
 }
 
+inline int hash_id(const std::string& ele, size_t nprocess) {
+  return hash_string(ele, nprocess); 
+}
+
+template <class IdType>
+inline int hash_id(const IdType& ele, size_t nprocess) { // integer ids
+  // Fibonacci hashing, spreading structured (e.g., mesh element) ids
+  const uint64_t h = static_cast<uint64_t>(ele) * 11400714819323198485ull; 
+
+  return (h >> 32) % nprocess; 
+}
+
 
 // Gather all element-root information to the process of the root
   // Step one: send to target processes
   // Step two: gather on target processes
 
-void send_2_target_processes(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline void send_2_target_processes(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
   int gid = cp.gid(); 
   diy::Link* l = cp.link();
   auto master = cp.master(); 
@@ -1274,19 +1314,17 @@ void send_2_target_processes(Block_Union_Find* b, const diy::Master::ProxyWithLi
   while(i != b->eles.end()) {
     auto& ele = (*i);
 
-    std::string root = b->parent(ele); 
+    IdType root = b->parent(ele); 
   
-    int gid_root = hash_string(root, nblocks); 
+    int gid_root = hash_id(root, nblocks); 
 
     if(gid_root != gid) {
-      std::pair<std::string, std::string> local_pair(ele, root); 
+      std::pair<IdType, IdType> local_pair(ele, root); 
 
-      auto& target = l->target(l->find(gid_root)); 
-
-      Message_Union_Find send_msg; 
+      Message_Union_Find_T<IdType> send_msg; 
       send_msg.send_ele_parent_pair(local_pair); 
 
-      cp.enqueue(target, send_msg); 
+      b->enqueue(gid_root, send_msg); 
 
       i = b->eles.erase(i);
     } else {
@@ -1294,9 +1332,12 @@ void send_2_target_processes(Block_Union_Find* b, const diy::Master::ProxyWithLi
     }
     
   }
+
+  b->flush_messages(cp); 
 }
 
-bool gather_on_target_processes(Block_Union_Find* b, const diy::Master::ProxyWithLink& cp) {
+template <class IdType>
+inline bool gather_on_target_processes(Block_Union_Find_T<IdType>* b, const diy::Master::ProxyWithLink& cp) {
 
   int gid = cp.gid(); 
   diy::Link* l = cp.link();
@@ -1310,17 +1351,19 @@ bool gather_on_target_processes(Block_Union_Find* b, const diy::Master::ProxyWit
     // dequeue data received from this neighbor block in the last exchange
     for (unsigned i = 0; i < in.size(); ++i) {
       if(cp.incoming(in[i])) {
-        Message_Union_Find msg; 
-        cp.dequeue(in[i], msg);
-
-        if(msg.tag == "ele_parent_pair") {
-            std::pair<std::string, std::string> pair; 
-            msg.receive_ele_parent_pair(pair); 
-
-            b->add(pair.first); 
-            b->set_parent(pair.first, pair.second); 
-        } else {
-          std::cout<<"Wrong! Tag is not correct: "<<msg.tag<<std::endl; 
+        std::vector<Message_Union_Find_T<IdType>> msgs; 
+        cp.dequeue(in[i], msgs);
+
+        for(auto& msg : msgs) {
+          if(msg.tag == MESSAGE_UNION_FIND_ELE_PARENT_PAIR) {
+              std::pair<IdType, IdType> pair; 
+              msg.receive_ele_parent_pair(pair); 
+
+              b->add(pair.first); 
+              b->set_parent(pair.first, pair.second); 
+          } else {
+            std::cout<<"Wrong! Tag is not correct: "<<msg.tag<<std::endl; 
+          }
         }
 
       }
@@ -1331,17 +1374,18 @@ bool gather_on_target_processes(Block_Union_Find* b, const diy::Master::ProxyWit
 }
 
 // Get sets of elements by redistributing data
-inline void Block_Union_Find::get_sets(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<std::set<std::string>>& results) {
+template <class IdType>
+inline void Block_Union_Find_T<IdType>::get_sets(diy::mpi::communicator& world, diy::Master& master, diy::ContiguousAssigner& assigner, std::vector<std::set<IdType>>& results) {
   #ifdef FTK_HAVE_MPI
     double start = MPI_Wtime();
   #endif
 
-  master.foreach(&send_2_target_processes); 
-  master.iexchange(&gather_on_target_processes); 
+  master.foreach(&send_2_target_processes<IdType>); 
+  master.iexchange(&gather_on_target_processes<IdType>); 
 
-  Block_Union_Find* b = this;
+  Block_Union_Find_T<IdType>* b = this;
 
-  std::map<std::string, std::set<std::string>> root2set; 
+  std::map<IdType, std::set<IdType>> root2set; 
 
   for(auto& ele : b->eles) {
     // if(!b->is_root(b->parent(ele))) {
@@ -32,6 +32,7 @@ struct simple_union_find
   bool unite(IdType p, IdType q) {
     IdType i = find(p);
     IdType j = find(q);
+    if (i == j) return false;
 
     if (sz[i] < sz[j]) {
       id2parent[i] = j; 
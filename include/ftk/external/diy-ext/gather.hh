@@ -3,14 +3,20 @@
 
 #include <ftk/external/diy/mpi.hpp>
 #include <ftk/external/diy-ext/serialization.hh>
+#include <map>
+#include <unordered_map>
+#include <type_traits>
+#include <cstdint>
 
 namespace diy { namespace mpi {
 
-template <typename K, typename V> // merging an std::map to root using gather
-inline void gather(const communicator& comm, const std::map<K, V>& in, std::map<K, V> &out, int root)
+template <typename T> // gathering serialized objects from non-root procs to root; 
+                      // the returned buffer is only non-empty on root
+inline std::string gather_serialized(const communicator& comm, const T& in, int root)
 {
+  std::string buffer;
 #if FTK_HAVE_MPI
-  // serialize input map
+  // serialize input
   std::string serialized_in;
   if (comm.rank() != root) // avoid serializing data from the root proc
     serializeToString(in, serialized_in);
@@ -23,7 +29,6 @@ inline void gather(const communicator& comm, const std::map<K, V>& in, std::map<
       root, comm);
 
   // preparing buffer and displacements for MPI_Gatherv
-  std::string buffer;
   std::vector<int> displs;
   if (comm.rank() == root) {
     buffer.resize(std::accumulate( // prepare buffer
@@ -39,21 +44,154 @@ inline void gather(const communicator& comm, const std::map<K, V>& in, std::map<
   MPI_Gatherv(serialized_in.data(), serialized_in.size(), MPI_CHAR, 
       &buffer[0], all_length_serialized_in.data(), displs.data(), MPI_CHAR, 
       root, comm);
+#endif
+  return buffer;
+}
 
-  // unserailization (root proc only)
+template <typename T> // gathering fixed-size records from all procs to root in the order of ranks 
+                      // with a single MPI_Gatherv, which receives them in place in out on root; 
+                      // out is in on other procs
+inline void gather_records(const communicator& comm, const std::vector<T>& in, std::vector<T>& out, int root)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "records must be trivially copyable");
+#if FTK_HAVE_MPI
+  if (&in == &out && comm.rank() == root) {
+    const std::vector<T> local(in);
+    gather_records(comm, local, out, root);
+    return;
+  }
+
+  int n = in.size();
+  std::vector<int> counts(comm.size(), 0), displs(comm.size(), 0);
+  MPI_Gather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
   if (comm.rank() == root) {
-    out = in;
-    StringBuffer sb(buffer);
-    while (sb) {
-      std::map<K, V> map;
-      load(sb, map);
-      for (const auto &kv : map)
-        out.insert(kv);
-    }
+    for (int i = 1; i < comm.size(); i ++)
+      displs[i] = displs[i-1] + counts[i-1];
+    out.resize(displs.back() + counts.back());
   }
-#else
-  out = in;
+
+  // counts are in records, so that the gathered bytes may exceed INT_MAX
+  MPI_Datatype record;
+  MPI_Type_contiguous(sizeof(T), MPI_BYTE, &record);
+  MPI_Type_commit(&record);
+  MPI_Gatherv(in.data(), n, record, 
+      comm.rank() == root ? out.data() : NULL, counts.data(), displs.data(), record, 
+      root, comm);
+  MPI_Type_free(&record);
+  if (comm.rank() != root) 
 #endif
+  out = in;
+}
+
+template <typename Map> // merging an associative container to root using gather
+inline void gather_map(const communicator& comm, const Map& in, Map& out, int root)
+{
+  std::string buffer = gather_serialized(comm, in, root);
+
+  // unserailization (root proc only)
+  out = in;
+  StringBuffer sb(buffer);
+  while (sb) {
+    Map map;
+    load(sb, map);
+    for (const auto &kv : map)
+      out.insert(kv);
+  }
+}
+
+template <typename K, typename V>
+inline void gather(const communicator& comm, const std::map<K, V>& in, std::map<K, V> &out, int root)
+{
+  gather_map(comm, in, out, root);
+}
+
+template <typename T> // concatenating vectors to root in the order of ranks
+inline void gather_vector(const communicator& comm, const std::vector<T>& in, std::vector<T>& out, int root)
+{
+  std::string buffer = gather_serialized(comm, in, root);
+
+  out = in;
+  StringBuffer sb(buffer);
+  while (sb) {
+    std::vector<T> vec;
+    load(sb, vec);
+    out.insert(out.end(), vec.begin(), vec.end());
+  }
+}
+
+namespace detail {
+  template <typename K, typename V> struct map_record {K key; V value;};
+
+  template <typename K, typename V> 
+  inline void gather_unordered_map(const communicator& comm, const std::unordered_map<K, V>& in, std::unordered_map<K, V> &out, int root, std::false_type)
+  {
+    gather_map(comm, in, out, root);
+  }
+
+  template <typename K, typename V> // as records of keys and values
+  inline void gather_unordered_map(const communicator& comm, const std::unordered_map<K, V>& in, std::unordered_map<K, V> &out, int root, std::true_type)
+  {
+    std::vector<map_record<K, V>> records;
+    records.reserve(in.size());
+    for (const auto &kv : in)
+      records.push_back({kv.first, kv.second});
+    gather_records(comm, records, records, root);
+
+    if (&in != &out) out = in;
+    if (comm.rank() != root) return;
+    out.reserve(records.size());
+    for (const auto &r : records)
+      out.insert(std::make_pair(r.key, r.value));
+  }
+
+  template <typename T>
+  inline void gather_vectors(const communicator& comm, const std::vector<std::vector<T>>& in, std::vector<std::vector<T>>& out, int root, std::false_type)
+  {
+    gather_vector(comm, in, out, root);
+  }
+
+  template <typename T> // as records of elements, and the lengths of the vectors
+  inline void gather_vectors(const communicator& comm, const std::vector<std::vector<T>>& in, std::vector<std::vector<T>>& out, int root, std::true_type)
+  {
+    std::vector<uint64_t> lengths;
+    std::vector<T> elements;
+    for (const auto &v : in) {
+      lengths.push_back(v.size());
+      elements.insert(elements.end(), v.begin(), v.end());
+    }
+    gather_records(comm, lengths, lengths, root);
+    gather_records(comm, elements, elements, root);
+
+    if (comm.rank() != root) {
+      if (&in != &out) out = in;
+      return;
+    }
+    out.resize(lengths.size());
+    const T *p = elements.data();
+    for (size_t i = 0; i < lengths.size(); i ++) {
+      out[i].assign(p, p + lengths[i]);
+      p += lengths[i];
+    }
+  }
+}
+
+template <typename K, typename V> // with fixed-size records if keys and values are trivially copyable
+inline void gather(const communicator& comm, const std::unordered_map<K, V>& in, std::unordered_map<K, V> &out, int root)
+{
+  detail::gather_unordered_map(comm, in, out, root, std::integral_constant<bool, 
+      std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value>());
+}
+
+template <typename T>
+inline void gather(const communicator& comm, const std::vector<T>& in, std::vector<T>& out, int root)
+{
+  gather_vector(comm, in, out, root);
+}
+
+template <typename T> // with fixed-size records if elements are trivially copyable
+inline void gather(const communicator& comm, const std::vector<std::vector<T>>& in, std::vector<std::vector<T>>& out, int root)
+{
+  detail::gather_vectors(comm, in, out, root, std::is_trivially_copyable<T>());
 }
 
 }
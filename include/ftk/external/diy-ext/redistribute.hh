@@ -0,0 +1,55 @@
+#ifndef _DIYEXT_REDISTRIBUTE_HH
+#define _DIYEXT_REDISTRIBUTE_HH
+
+#include <ftk/external/diy/mpi.hpp>
+#include <ftk/external/diy-ext/serialization.hh>
+#include <numeric>
+#include <vector>
+
+namespace diy { namespace mpi {
+
+template <typename T> // personalized all-to-all exchange of serializable objects:
+                      // in[i] is sent to proc i, and out[i] is received from proc i
+inline void redistribute(const communicator& comm, const std::vector<T>& in, std::vector<T>& out)
+{
+  assert(in.size() == comm.size());
+#if FTK_HAVE_MPI
+  const int np = comm.size();
+
+  // serialize outgoing objects
+  std::string send_buffer, serialized;
+  std::vector<int> send_counts(np, 0), send_displs(np, 0);
+  for (int i = 0; i < np; i ++) {
+    serializeToString(in[i], serialized);
+    send_displs[i] = send_buffer.size();
+    send_counts[i] = serialized.size();
+    send_buffer.append(serialized);
+  }
+
+  // exchange lengths of serialized data
+  std::vector<int> recv_counts(np, 0), recv_displs(np, 0);
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT,
+      recv_counts.data(), 1, MPI_INT, comm);
+  for (int i = 1; i < np; i ++)
+    recv_displs[i] = recv_displs[i-1] + recv_counts[i-1];
+
+  std::string recv_buffer;
+  recv_buffer.resize(std::accumulate(recv_counts.begin(), recv_counts.end(), 0));
+
+  MPI_Alltoallv(&send_buffer[0], send_counts.data(), send_displs.data(), MPI_CHAR,
+      &recv_buffer[0], recv_counts.data(), recv_displs.data(), MPI_CHAR, comm);
+
+  // unserialization
+  std::vector<T> results(np);
+  for (int i = 0; i < np; i ++)
+    unserializeFromString(recv_buffer.substr(recv_displs[i], recv_counts[i]), results[i]);
+  out.swap(results);
+#else
+  out = in;
+#endif
+}
+
+}
+}
+
+#endif
@@ -5,6 +5,11 @@
 #include <ftk/filters/filter.hh>
 #include <ftk/filters/critical_point.hh>
 #include <ftk/geometry/points2vtk.hh>
+#include <ftk/ndarray/minmax_pyramid.hh>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace ftk {
 
@@ -13,7 +18,6 @@ struct critical_point_tracker : public filter {
   critical_point_tracker() {}
 
   virtual void update() {}; // TODO
-  void reset() {field_data_snapshots.clear();}
 
 #if FTK_HAVE_VTK
   virtual vtkSmartPointer<vtkPolyData> get_traced_critical_points_vtk() const = 0;
@@ -28,77 +32,209 @@ struct critical_point_tracker : public filter {
   void write_traced_critical_points_text(const std::string& filename);
   void write_discrete_critical_points_text(const std::string& filename);
 
+  // Jacobians (up to 3x3) evaluated on demand at vertices, indexed by the 
+  // offset of the vertex in the arrays; shared by the threads of the trackers
+  template <typename T>
+  struct jacobian_cache_t {
+    template <typename F> std::array<T, 9> get(size_t v, F&& eval) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = values.find(v);
+      if (it == values.end()) {
+        std::array<T, 9> J;
+        eval(J);
+        it = values.insert(std::make_pair(v, J)).first;
+      }
+      return it->second;
+    }
+
+    std::mutex mutex;
+    std::unordered_map<size_t, std::array<T, 9>> values;
+  };
+
+  // Field data are stored in the value type of the tracker, e.g. float to 
+  // halve the memory footprint and bandwidth of the snapshots; values are 
+  // promoted to double when they are read for the inverse interpolation.
+  template <typename T>
   struct field_data_snapshot_t {
-    ndarray<double> scalar, vector, jacobian;
+    ndarray<T> scalar, vector, jacobian;
+    minmax_pyramid<T> vector_bounds; // built by the trackers on first use
+    std::shared_ptr<jacobian_cache_t<T>> jacobian_cache; // if the jacobian field is lazy
+  };
+
+  // Arrays of popped snapshots, reused by the snapshots pushed later so 
+  // that steady-state tracking neither allocates nor first touches 
+  // snapshot-sized buffers; mapped or aliased arrays are never reused.
+  template <typename T>
+  struct field_data_buffer_pool_t {
+    // a buffer of at least n elements (with any shape), or an empty array
+    ndarray<T> get(size_t n) {
+      size_t k = buffers.size();
+      for (size_t i = 0; i < buffers.size(); i ++) 
+        if (buffers[i].nelem() >= n && (k == buffers.size() || buffers[i].nelem() < buffers[k].nelem()))
+          k = i;
+      if (k == buffers.size()) return ndarray<T>();
+      ndarray<T> a(std::move(buffers[k]));
+      buffers.erase(buffers.begin() + k);
+      return a;
+    }
+
+    void put(ndarray<T>& a) { // takes the elements of a
+      if (!a.empty() && !a.is_mapped() && buffers.size() < max_buffers)
+        buffers.push_back(std::move(a));
+      a = ndarray<T>();
+    }
+
+    void recycle(field_data_snapshot_t<T>& s) {put(s.scalar); put(s.vector); put(s.jacobian);}
+
+    // copies or converts in to out in a reused buffer; mapped or aliased 
+    // arrays of the value type are shared instead
+    void copy(const ndarray<T>& in, ndarray<T>& out) {
+      if (in.empty() || in.is_mapped()) out = in;
+      else {out = get(in.nelem()); out = in;}
+    }
+    template <typename T1> void copy(const ndarray<T1>& in, ndarray<T>& out) {
+      if (in.empty()) out = ndarray<T>();
+      else {out = get(in.nelem()); out.from_array(in);}
+    }
+
+    void take(ndarray<T>&& in, ndarray<T>& out) {out = std::move(in);}
+    template <typename T1> void take(ndarray<T1>&& in, ndarray<T>& out) {copy(in, out);}
+
+    size_t max_buffers = 8;
+    std::vector<ndarray<T>> buffers;
   };
 
-  bool pop_field_data_snapshot();
+  // fixed-rank accessors to the fields of a snapshot of ND-dimensional 
+  // data; unavailable fields are left empty
+  template <typename T, int ND>
+  struct field_data_accessor_t {
+    fixed_ndarray<const T, ND> scalar;
+    fixed_ndarray<const T, ND+1> vector;
+    fixed_ndarray<const T, ND+2> jacobian;
+
+    void bind(const field_data_snapshot_t<T>& s) {
+      *this = field_data_accessor_t();
+      if (s.scalar.nd() == ND && !s.scalar.empty()) scalar = s.scalar.template fixed<ND>();
+      if (s.vector.nd() == ND+1 && !s.vector.empty()) vector = s.vector.template fixed<ND+1>();
+      if (s.jacobian.nd() == ND+2 && !s.jacobian.empty()) jacobian = s.jacobian.template fixed<ND+2>();
+    }
+  };
+
+  virtual bool pop_field_data_snapshot() = 0;
+  virtual size_t num_field_data_snapshots() const = 0;
+
   virtual void push_field_data_snapshot(
       const ndarray<double> &scalar, 
       const ndarray<double> &vector,
-      const ndarray<double> &jacobian);
-  virtual void push_scalar_field_snapshot(const ndarray<double> &scalar); // push scalar only
+      const ndarray<double> &jacobian) = 0;
+  virtual void push_field_data_snapshot(
+      const ndarray<float> &scalar, 
+      const ndarray<float> &vector,
+      const ndarray<float> &jacobian) = 0;
+  virtual void push_scalar_field_snapshot(const ndarray<double> &scalar) = 0; // push scalar only
+  virtual void push_scalar_field_snapshot(const ndarray<float> &scalar) = 0;
 
-  virtual void push_field_data_spacetime(
-      const ndarray<double> &scalars, 
-      const ndarray<double> &vectors,
-      const ndarray<double> &jacobians);
-  void push_scalar_field_spacetime(const ndarray<double>& scalars);
+  // the trackers take the elements of arrays of their value type instead 
+  // of copying them
+  virtual void push_field_data_snapshot(
+      ndarray<double> &&scalar, 
+      ndarray<double> &&vector,
+      ndarray<double> &&jacobian) = 0;
+  virtual void push_field_data_snapshot(
+      ndarray<float> &&scalar, 
+      ndarray<float> &&vector,
+      ndarray<float> &&jacobian) = 0;
+  virtual void push_scalar_field_snapshot(ndarray<double> &&scalar) = 0;
+  virtual void push_scalar_field_snapshot(ndarray<float> &&scalar) = 0;
 
-protected:
-  std::deque<field_data_snapshot_t> field_data_snapshots;
-};
+  template <typename T>
+  void push_field_data_spacetime(
+      const ndarray<T> &scalars, 
+      const ndarray<T> &vectors,
+      const ndarray<T> &jacobians);
+  template <typename T>
+  void push_scalar_field_spacetime(const ndarray<T>& scalars);
 
-///////
+  // Same as above, but snapshots refer to the time slices of the views 
+  // instead of copies if they are contiguous and of the value type of the 
+  // tracker; the viewed memory must outlive the snapshots.  Empty views 
+  // are pushed as empty arrays.
+  template <typename T>
+  void push_field_data_spacetime(
+      const ndarray_view<T> &scalars, 
+      const ndarray_view<T> &vectors,
+      const ndarray_view<T> &jacobians);
+  template <typename T>
+  void push_scalar_field_spacetime(const ndarray_view<T>& scalars);
 
-inline void critical_point_tracker::push_field_data_snapshot(
-    const ndarray<double>& scalar,
-    const ndarray<double>& vector,
-    const ndarray<double>& jacobian)
-{
-  field_data_snapshot_t snapshot;
-  snapshot.scalar = scalar;
-  snapshot.vector = vector;
-  snapshot.jacobian = jacobian;
-
-  field_data_snapshots.emplace_back(snapshot);
-}
+protected:
+  // copies field data to the storage, converting values if necessary
+  template <typename T>
+  static void convert_field_data(const ndarray<T>& in, ndarray<T>& out) {out = in;}
+  template <typename T, typename T1>
+  static void convert_field_data(const ndarray<T1>& in, ndarray<T>& out);
 
-inline void critical_point_tracker::push_scalar_field_snapshot(const ndarray<double>& scalar)
-{
-  field_data_snapshot_t snapshot;
-  snapshot.scalar = scalar;
+  // pointer to double precision field data, converted into buf if necessary
+  static const double* field_data_double(const ndarray<double>& in, ndarray<double>&) {return in.data();}
+  static const double* field_data_double(const ndarray<float>& in, ndarray<double>& buf);
+};
 
-  field_data_snapshots.emplace_back(snapshot);
-}
+///////
 
+template <typename T>
 inline void critical_point_tracker::push_field_data_spacetime(
-    const ndarray<double>& scalars,
-    const ndarray<double>& vectors,
-    const ndarray<double>& jacobians)
+    const ndarray<T>& scalars,
+    const ndarray<T>& vectors,
+    const ndarray<T>& jacobians)
 {
   for (size_t t = 0; t < scalars.shape(scalars.nd()-1); t ++) {
     auto scalar = scalars.slice_time(t);
     auto vector = vectors.slice_time(t);
     auto jacobian = jacobians.slice_time(t);
 
-    push_field_data_snapshot(scalar, vector, jacobian);
+    push_field_data_snapshot(std::move(scalar), std::move(vector), std::move(jacobian));
   }
 }
 
-inline void critical_point_tracker::push_scalar_field_spacetime(const ndarray<double>& scalars)
+template <typename T>
+inline void critical_point_tracker::push_scalar_field_spacetime(const ndarray<T>& scalars)
 {
   for (size_t t = 0; t < scalars.shape(scalars.nd()-1); t ++)
     push_scalar_field_snapshot( scalars.slice_time(t) );
 }
 
+template <typename T>
+inline void critical_point_tracker::push_field_data_spacetime(
+    const ndarray_view<T>& scalars,
+    const ndarray_view<T>& vectors,
+    const ndarray_view<T>& jacobians)
+{
+  auto slice = [](const ndarray_view<T>& v, size_t t) {
+    return v.empty() ? ndarray<T>() : ndarray<T>::alias(v.slice_time(t));
+  };
+  for (size_t t = 0; t < scalars.shape(scalars.nd()-1); t ++) 
+    push_field_data_snapshot(slice(scalars, t), slice(vectors, t), slice(jacobians, t));
+}
+
+template <typename T>
+inline void critical_point_tracker::push_scalar_field_spacetime(const ndarray_view<T>& scalars)
+{
+  for (size_t t = 0; t < scalars.shape(scalars.nd()-1); t ++)
+    push_scalar_field_snapshot( ndarray<T>::alias(scalars.slice_time(t)) );
+}
+
+template <typename T, typename T1>
+inline void critical_point_tracker::convert_field_data(const ndarray<T1>& in, ndarray<T>& out)
+{
+  if (in.empty()) out = ndarray<T>();
+  else out.from_array(in);
+}
 
-inline bool critical_point_tracker::pop_field_data_snapshot()
+inline const double* critical_point_tracker::field_data_double(const ndarray<float>& in, ndarray<double>& buf)
 {
-  if (field_data_snapshots.size() > 0) {
-    field_data_snapshots.pop_front();
-    return true;
-  } else return false;
+  if (in.empty()) return NULL;
+  convert_field_data(in, buf);
+  return buf.data();
 }
 
 //////
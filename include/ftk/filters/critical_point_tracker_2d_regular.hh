@@ -8,6 +8,7 @@
 #include <ftk/numeric/linear_interpolation.hh>
 #include <ftk/numeric/bilinear_interpolation.hh>
 #include <ftk/numeric/inverse_linear_interpolation_solver.hh>
+#include <ftk/numeric/inverse_linear_interpolation_solver_batch.hh>
 #include <ftk/numeric/inverse_bilinear_interpolation_solver.hh>
 #include <ftk/numeric/gradient.hh>
 #include <ftk/numeric/adjugate.hh>
@@ -23,6 +24,8 @@
 #include <ftk/ndarray/grad.hh>
 #include <ftk/hypermesh/regular_simplex_mesh.hh>
 #include <ftk/external/diy/serialization.hpp>
+#include <unordered_map>
+#include <chrono>
 
 #if FTK_HAVE_VTK
 #include <vtkUnsignedIntArray.h>
@@ -50,20 +53,41 @@ namespace ftk {
 
 typedef critical_point_t<3, double> critical_point_2dt_t;
 
-struct critical_point_tracker_2d_regular : public critical_point_tracker_regular {
-  critical_point_tracker_2d_regular() : m(3) {}
-  critical_point_tracker_2d_regular(int argc, char **argv) 
+// T is the value type of the stored field data
+template <typename T=double>
+struct critical_point_tracker_2d_regular_t : public critical_point_tracker_regular {
+  critical_point_tracker_2d_regular_t() : m(3) {}
+  critical_point_tracker_2d_regular_t(int argc, char **argv) 
     : critical_point_tracker_regular(argc, argv), m(3) {}
-  virtual ~critical_point_tracker_2d_regular() {}
+  virtual ~critical_point_tracker_2d_regular_t() {}
 
   void initialize();
   void finalize();
   void reset();
 
   void update_timestep();
+  void rebalance();
 
+  // Trajectories are passed to f as they are completed instead of being 
+  // stored, which is useful in the streaming mode
+  void set_trajectory_callback(std::function<void(const std::vector<critical_point_2dt_t>&)> f) {trajectory_callback = f;}
+
+  bool pop_field_data_snapshot();
+  size_t num_field_data_snapshots() const {return field_data_snapshots.size();}
+
+  void push_field_data_snapshot(const ndarray<double>&, const ndarray<double>&, const ndarray<double>&);
+  void push_field_data_snapshot(const ndarray<float>&, const ndarray<float>&, const ndarray<float>&);
   void push_scalar_field_snapshot(const ndarray<double>&);
+  void push_scalar_field_snapshot(const ndarray<float>&);
   void push_vector_field_snapshot(const ndarray<double>&);
+  void push_vector_field_snapshot(const ndarray<float>&);
+
+  void push_field_data_snapshot(ndarray<double>&&, ndarray<double>&&, ndarray<double>&&);
+  void push_field_data_snapshot(ndarray<float>&&, ndarray<float>&&, ndarray<float>&&);
+  void push_scalar_field_snapshot(ndarray<double>&&);
+  void push_scalar_field_snapshot(ndarray<float>&&);
+  void push_vector_field_snapshot(ndarray<double>&&);
+  void push_vector_field_snapshot(ndarray<float>&&);
 
 #if FTK_HAVE_VTK
   virtual vtkSmartPointer<vtkPolyData> get_traced_critical_points_vtk() const;
@@ -85,33 +109,52 @@ protected:
   unsigned int type_filter = 0xffffffff;
 
   typedef regular_simplex_mesh_element element_t;
+  typedef regular_simplex_mesh_fixed_element<3> fixed_element_t;
   
-  std::map<element_t, critical_point_2dt_t> discrete_critical_points;
-  std::vector<std::set<element_t>> connected_components;
+  std::unordered_map<uint64_t, critical_point_2dt_t> discrete_critical_points; // indexed by element_t::to_integer()
+  std::vector<std::vector<uint64_t>> connected_components; // element ids
   std::vector<std::vector<critical_point_2dt_t>> traced_critical_points;
+  std::function<void(const std::vector<critical_point_2dt_t>&)> trajectory_callback;
+
+  std::deque<field_data_snapshot_t<T>> field_data_snapshots;
+  field_data_buffer_pool_t<T> snapshot_buffers; // of popped snapshots
+  field_data_accessor_t<T, 2> snapshot_fields[2]; // of the first two snapshots, bound by update_timestep
+
+  // per-thread (element id, critical point) buffers that are merged into 
+  // discrete_critical_points at the end of each timestep
+  std::vector<std::vector<std::pair<uint64_t, critical_point_2dt_t>>> thread_critical_points;
+  std::vector<simplex_batch_t<3>> thread_simplex_batches;
 
 protected:
-  bool check_simplex(const element_t& s, critical_point_2dt_t& cp);
+  bool check_simplex(const fixed_element_t& s, const int vertices[][3], critical_point_2dt_t& cp);
+  void check_simplex_batch(simplex_batch_t<3>& b, int tid); // and empties the batch
+  void interpolate_critical_point(const int vertices[][3], const double mu[3], critical_point_2dt_t& cp) const;
   void trace_intersections();
-  void trace_connected_components();
-
-  template <typename I=int> void simplex_indices(const std::vector<std::vector<int>>& vertices, I indices[]) const;
-  virtual void simplex_coordinates(const std::vector<std::vector<int>>& vertices, double X[][3]) const;
-  template <typename T=double> void simplex_vectors(const std::vector<std::vector<int>>& vertices, T v[][2]) const;
-  virtual void simplex_scalars(const std::vector<std::vector<int>>& vertices, double values[]) const;
-  virtual void simplex_jacobians(const std::vector<std::vector<int>>& vertices, 
+  void trace_connected_components(bool closed_only = false);
+  void merge_thread_critical_points();
+  void derive_field_data(field_data_snapshot_t<T>& snapshot);
+
+  template <typename I=int> void simplex_indices(int n, const int vertices[][3], I indices[]) const;
+  virtual void simplex_coordinates(int n, const int vertices[][3], double X[][3]) const;
+  template <typename T1=double> void simplex_vectors(int n, const int vertices[][3], T1 v[][2]) const;
+  virtual void simplex_scalars(int n, const int vertices[][3], double values[]) const;
+  virtual void simplex_jacobians(int n, const int vertices[][3], 
       double Js[][2][2]) const;
 
 protected: // working in progress
-  bool robust_check_simplex0(const element_t& s, critical_point_2dt_t &cp);
-  bool robust_check_simplex1(const element_t& s, critical_point_2dt_t &cp);
-  bool robust_check_simplex2(const element_t& s, critical_point_2dt_t &cp);
+  bool robust_check_simplex0(const fixed_element_t& s, const int vertices[][3], critical_point_2dt_t &cp);
+  bool robust_check_simplex1(const fixed_element_t& s, const int vertices[][3], critical_point_2dt_t &cp);
+  bool robust_check_simplex2(const fixed_element_t& s, const int vertices[][3], critical_point_2dt_t &cp);
 };
 
+typedef critical_point_tracker_2d_regular_t<double> critical_point_tracker_2d_regular;
 
 ////////////////////
-inline void critical_point_tracker_2d_regular::initialize()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::initialize()
 {
+  initialize_number_of_threads();
+
   // initializing bounds
   m.set_lb_ub({
       static_cast<int>(domain.start(0)),
@@ -123,104 +166,274 @@ inline void critical_point_tracker_2d_regular::initialize()
       end_timestep
     });
 
+  int np, rank; // of the spatial partition in the time window
+  partition_time_windows(np, rank);
+
   if (use_default_domain_partition) {
     lattice_partitioner partitioner(domain);
     
     // a ghost size of 2 is necessary for jacobian derivaition; 
     // even if jacobian is not necessary, a ghost size of 1 is 
     // necessary for accessing values on boundaries
-    partitioner.partition(comm.size(), {}, {2, 2});
+    partitioner.partition(np, {}, {2, 2});
 
-    local_domain = partitioner.get_core(comm.rank());
-    local_array_domain = partitioner.get_ext(comm.rank());
+    local_domain = partitioner.get_core(rank);
+    local_array_domain = partitioner.get_ext(rank);
   }
 
-  if (!is_input_array_partial)
+  // with partial input arrays, the ghost layers are taken from the array 
+  // domain: the cubes on the upper side of the core reach one vertex 
+  // further, and the jacobians there are derived from scalars two vertices 
+  // away
+  if (is_input_array_partial)
+    local_array_domain = partial_array_domain(local_domain, 2, 3);
+  else 
     local_array_domain = array_domain;
 }
 
-inline void critical_point_tracker_2d_regular::finalize()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::finalize()
 {
-  diy::mpi::gather(comm, discrete_critical_points, discrete_critical_points, 0);
-
-  if (comm.rank() == 0) {
+  if (comm.size() > 1 && !use_streaming_trajectories) {
+    if (comm.rank() == 0) fprintf(stderr, "finalizing...\n");
+    redistribute_connected_components<3>(m, 2, discrete_critical_points);
+    trace_connected_components();
+    diy::mpi::gather(comm, traced_critical_points, traced_critical_points, 0);
+  } else if (comm.rank() == 0) { // discrete critical points are already gathered in the streaming mode
     fprintf(stderr, "finalizing...\n");
     // trace_intersections();
     trace_connected_components();
   }
 }
 
-inline void critical_point_tracker_2d_regular::reset()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::reset()
 {
   current_timestep = 0;
 
   field_data_snapshots.clear();
   discrete_critical_points.clear();
+  thread_critical_points.clear();
   traced_critical_points.clear();
   connected_components.clear();
 }
 
-inline void critical_point_tracker_2d_regular::push_scalar_field_snapshot(const ndarray<double>& s)
+template <typename T>
+inline bool critical_point_tracker_2d_regular_t<T>::pop_field_data_snapshot()
 {
-  field_data_snapshot_t snapshot;
-  
-  snapshot.scalar = s;
-  if (vector_field_source == SOURCE_DERIVED) {
-    snapshot.vector = gradient2D(s);
-    if (jacobian_field_source == SOURCE_DERIVED)
-      snapshot.jacobian = jacobian2D(snapshot.vector);
-  }
+  if (field_data_snapshots.size() > 0) {
+    snapshot_buffers.recycle(field_data_snapshots.front());
+    field_data_snapshots.pop_front();
+    return true;
+  } else return false;
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_field_data_snapshot(
+    const ndarray<double>& scalar, const ndarray<double>& vector, const ndarray<double>& jacobian)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(scalar, snapshot.scalar);
+  snapshot_buffers.copy(vector, snapshot.vector);
+  snapshot_buffers.copy(jacobian, snapshot.jacobian);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
 
-  field_data_snapshots.emplace_back( snapshot );
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_field_data_snapshot(
+    const ndarray<float>& scalar, const ndarray<float>& vector, const ndarray<float>& jacobian)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(scalar, snapshot.scalar);
+  snapshot_buffers.copy(vector, snapshot.vector);
+  snapshot_buffers.copy(jacobian, snapshot.jacobian);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
 }
 
-inline void critical_point_tracker_2d_regular::push_vector_field_snapshot(const ndarray<double>& v)
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_scalar_field_snapshot(const ndarray<double>& s)
 {
-  field_data_snapshot_t snapshot;
- 
-  snapshot.vector = v;
-  if (jacobian_field_source == SOURCE_DERIVED)
-    snapshot.jacobian = jacobian2D(snapshot.vector);
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(s, snapshot.scalar);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_scalar_field_snapshot(const ndarray<float>& s)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(s, snapshot.scalar);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
 
-  field_data_snapshots.emplace_back( snapshot );
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_vector_field_snapshot(const ndarray<double>& v)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(v, snapshot.vector);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
 }
 
-inline void critical_point_tracker_2d_regular::update_timestep()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_vector_field_snapshot(const ndarray<float>& v)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.copy(v, snapshot.vector);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_field_data_snapshot(
+    ndarray<double>&& scalar, ndarray<double>&& vector, ndarray<double>&& jacobian)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(scalar), snapshot.scalar);
+  snapshot_buffers.take(std::move(vector), snapshot.vector);
+  snapshot_buffers.take(std::move(jacobian), snapshot.jacobian);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_field_data_snapshot(
+    ndarray<float>&& scalar, ndarray<float>&& vector, ndarray<float>&& jacobian)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(scalar), snapshot.scalar);
+  snapshot_buffers.take(std::move(vector), snapshot.vector);
+  snapshot_buffers.take(std::move(jacobian), snapshot.jacobian);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_scalar_field_snapshot(ndarray<double>&& s)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(s), snapshot.scalar);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_scalar_field_snapshot(ndarray<float>&& s)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(s), snapshot.scalar);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_vector_field_snapshot(ndarray<double>&& v)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(v), snapshot.vector);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::push_vector_field_snapshot(ndarray<float>&& v)
+{
+  field_data_snapshot_t<T> snapshot;
+  snapshot_buffers.take(std::move(v), snapshot.vector);
+  derive_field_data(snapshot);
+  field_data_snapshots.emplace_back( std::move(snapshot) );
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::derive_field_data(field_data_snapshot_t<T>& snapshot)
+{
+  // derived fields are computed in the value type of the snapshot, and 
+  // written to the buffers of popped snapshots if any
+  const bool lazy_jacobian = use_lazy_jacobian_field && xl == FTK_XL_NONE;
+  const size_t n = snapshot.scalar.nelem();
+  const int gw = is_input_array_partial ? array_domain.size(0) : 0, // derivatives of blocks
+            gh = is_input_array_partial ? array_domain.size(1) : 0; // are scaled by the domain
+
+  if (vector_field_source == SOURCE_DERIVED && snapshot.vector.empty() && !snapshot.scalar.empty()) {
+    snapshot.vector = snapshot_buffers.get(2 * n);
+    if (jacobian_field_source == SOURCE_DERIVED && snapshot.jacobian.empty() && !lazy_jacobian) {
+      snapshot.jacobian = snapshot_buffers.get(4 * n);
+      gradient_jacobian2D(snapshot.scalar, snapshot.vector, snapshot.jacobian, 16, gw, gh); // single pass
+    } else 
+      gradient2D(snapshot.scalar, snapshot.vector, gw, gh);
+  }
+  if (jacobian_field_source == SOURCE_DERIVED && snapshot.jacobian.empty() && !snapshot.vector.empty()) {
+    if (lazy_jacobian) 
+      snapshot.jacobian_cache = std::make_shared<jacobian_cache_t<T>>();
+    else {
+      snapshot.jacobian = snapshot_buffers.get(2 * snapshot.vector.nelem());
+      jacobian2D(snapshot.vector, snapshot.jacobian, gw, gh);
+    }
+  }
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::rebalance()
+{
+  const lattice old_block = local_array_domain;
+  if (!repartition()) return;
+  if (comm.rank() == 0) fprintf(stderr, "rebalanced at timestep %d\n", current_timestep);
+
+  if (!use_streaming_trajectories) // otherwise gathered to the root proc
+    migrate_critical_points<3>(m, 2, discrete_critical_points);
+
+  if (is_input_array_partial) 
+    for (auto &s : field_data_snapshots) {
+      migrate_field_data(s, old_block, snapshot_buffers);
+      derive_field_data(s);
+    }
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::update_timestep()
 {
   if (comm.rank() == 0) fprintf(stderr, "current_timestep=%d\n", current_timestep);
+  if (!scanning_timestep()) return; // by the next time window
+  thread_critical_points.resize(m.nthread_ids(nthreads));
+  thread_simplex_batches.resize(m.nthread_ids(nthreads));
+  for (size_t i = 0; i < std::min(field_data_snapshots.size(), size_t(2)); i ++)
+    snapshot_fields[i].bind(field_data_snapshots[i]);
 
-  auto func0 = [=](element_t e) {
+  auto func0 = [=](const fixed_element_t& e, const int vertices[][3], int tid) {
       critical_point_2dt_t cp;
-      if (robust_check_simplex0(e, cp)) {
-        std::lock_guard<std::mutex> guard(mutex);
-        if (filter_critical_point_type(cp))
-          discrete_critical_points[e] = cp;
-      }
+      if (robust_check_simplex0(e, vertices, cp) && filter_critical_point_type(cp))
+        thread_critical_points[tid].push_back(std::make_pair(e.to_integer(m), cp));
     };
   
-  auto func1 = [=](element_t e) {
+  auto func1 = [=](const fixed_element_t& e, const int vertices[][3], int tid) {
       critical_point_2dt_t cp;
-      if (robust_check_simplex1(e, cp)) {
-        std::lock_guard<std::mutex> guard(mutex);
-        if (filter_critical_point_type(cp))
-          discrete_critical_points[e] = cp;
-      }
+      if (robust_check_simplex1(e, vertices, cp) && filter_critical_point_type(cp))
+        thread_critical_points[tid].push_back(std::make_pair(e.to_integer(m), cp));
     };
 
   // scan 2-simplices
   // fprintf(stderr, "tracking 2D critical points...\n");
-  auto func2 = [=](element_t e) {
-      critical_point_2dt_t cp;
-      if (check_simplex(e, cp)) {
-        std::lock_guard<std::mutex> guard(mutex);
-        if (filter_critical_point_type(cp))
-          discrete_critical_points[e] = cp;
-      }
+  auto func2 = [=](const fixed_element_t& e, const int vertices[][3], int tid) {
+      if (!e.valid(m)) return;
+      double v[3][2];
+      simplex_vectors(3, vertices, v);
+
+      auto &b = thread_simplex_batches[tid]; // solved when full
+      b.push(e, vertices, v);
+      if (b.full()) check_simplex_batch(b, tid);
     };
 
   if (xl == FTK_XL_NONE) {
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // only the simplices in cubes that pass the quick-reject test are checked
+    for (size_t i = 0; i < std::min(field_data_snapshots.size(), size_t(2)); i ++)
+      if (field_data_snapshots[i].vector_bounds.empty()) // once per timestep
+        field_data_snapshots[i].vector_bounds.build(field_data_snapshots[i].vector);
+    std::vector<std::array<int, 3>> cubes;
+
     // m.element_for_ordinal(2, current_timestep, func2);
-    m.element_for(2, lattice({ // ordinal
+    candidate_cubes<3>(lattice({ // ordinal
           local_domain.start(0), 
           local_domain.start(1), 
           static_cast<size_t>(current_timestep), 
@@ -229,12 +442,14 @@ inline void critical_point_tracker_2d_regular::update_timestep()
           local_domain.size(1), 
           1
         }), 
-        ftk::ELEMENT_SCOPE_ORDINAL, 
-        func2, nthreads);
+        ftk::ELEMENT_SCOPE_ORDINAL, field_data_snapshots[0], field_data_snapshots[0], cubes);
+    if (rebalancing()) count_candidate_cubes<3>(cubes);
+    m.element_for<3, 2>(cubes, ftk::ELEMENT_SCOPE_ORDINAL, func2, nthreads);
     
     if (field_data_snapshots.size() >= 2) { // interval
       // m.element_for_interval(2, current_timestep-1, current_timestep, func2);
-      m.element_for(2, lattice({
+      cubes.clear();
+      candidate_cubes<3>(lattice({
             local_domain.start(0), 
             local_domain.start(1), 
             // static_cast<size_t>(current_timestep - 1), 
@@ -244,9 +459,17 @@ inline void critical_point_tracker_2d_regular::update_timestep()
             local_domain.size(1), 
             1
           }),
-          ftk::ELEMENT_SCOPE_INTERVAL, 
-          func2, nthreads);
+          ftk::ELEMENT_SCOPE_INTERVAL, field_data_snapshots[0], field_data_snapshots[1], cubes);
+      if (rebalancing()) count_candidate_cubes<3>(cubes);
+      m.element_for<3, 2>(cubes, ftk::ELEMENT_SCOPE_INTERVAL, func2, nthreads);
     }
+
+    for (size_t tid = 0; tid < thread_simplex_batches.size(); tid ++)
+      check_simplex_batch(thread_simplex_batches[tid], tid);
+    merge_thread_critical_points();
+
+    if (rebalancing())
+      add_cost(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
   } else if (xl == FTK_XL_CUDA) {
 #if FTK_HAVE_CUDA
     ftk::lattice domain3({
@@ -283,6 +506,12 @@ inline void critical_point_tracker_2d_regular::update_timestep()
     ftk::lattice ext({0, 0}, 
         {field_data_snapshots[0].vector.dim(1), 
         field_data_snapshots[0].vector.dim(2)});
+
+    // the kernels take double precision field data
+    ndarray<double> buf[6];
+    auto V = [&](int i) {return field_data_double(field_data_snapshots[i].vector, buf[i]);};
+    auto J = [&](int i) {return field_data_double(field_data_snapshots[i].jacobian, buf[2+i]);};
+    auto S = [&](int i) {return field_data_double(field_data_snapshots[i].scalar, buf[4+i]);};
     
     // ordinal
     auto results = extract_cp2dt_cuda(
@@ -291,11 +520,11 @@ inline void critical_point_tracker_2d_regular::update_timestep()
         domain3,
         ordinal_core,
         ext,
-        field_data_snapshots[0].vector.data(),
+        V(0),
         NULL, // V[0].data(),
-        field_data_snapshots[0].jacobian.data(),
+        J(0),
         NULL, // gradV[0].data(),
-        field_data_snapshots[0].scalar.data(),
+        S(0),
         NULL, // scalar[0].data(),
         use_explicit_coords, 
         coords.data()
@@ -304,7 +533,7 @@ inline void critical_point_tracker_2d_regular::update_timestep()
     for (auto cp : results) {
       element_t e(3, 2);
       e.from_work_index(m, cp.tag, ordinal_core, ELEMENT_SCOPE_ORDINAL);
-      discrete_critical_points[e] = cp;
+      discrete_critical_points[e.to_integer(m)] = cp;
     }
 
     if (field_data_snapshots.size() >= 2) { // interval
@@ -315,12 +544,12 @@ inline void critical_point_tracker_2d_regular::update_timestep()
           domain3, 
           interval_core,
           ext,
-          field_data_snapshots[0].vector.data(), // current
-          field_data_snapshots[1].vector.data(), // next
-          field_data_snapshots[0].jacobian.data(), 
-          field_data_snapshots[1].jacobian.data(),
-          field_data_snapshots[0].scalar.data(),
-          field_data_snapshots[1].scalar.data(),
+          V(0), // current
+          V(1), // next
+          J(0), 
+          J(1),
+          S(0),
+          S(1),
           use_explicit_coords, 
           coords.data()
         );
@@ -328,21 +557,46 @@ inline void critical_point_tracker_2d_regular::update_timestep()
       for (auto cp : results) {
         element_t e(3, 2);
         e.from_work_index(m, cp.tag, interval_core, ELEMENT_SCOPE_INTERVAL);
-        discrete_critical_points[e] = cp;
+        discrete_critical_points[e.to_integer(m)] = cp;
       }
     }
 #else
     assert(false);
 #endif
   }
+
+  if (use_streaming_trajectories) {
+    diy::mpi::gather(comm, discrete_critical_points, discrete_critical_points, 0);
+    if (comm.rank() == 0) trace_connected_components(true);
+    else discrete_critical_points.clear();
+  }
 }
 
-inline void critical_point_tracker_2d_regular::trace_intersections()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::merge_thread_critical_points()
+{
+  size_t n = discrete_critical_points.size();
+  for (const auto &results : thread_critical_points)
+    n += results.size();
+  discrete_critical_points.reserve(n);
+
+  for (auto &results : thread_critical_points) {
+    for (const auto &kv : results)
+      discrete_critical_points[kv.first] = kv.second;
+    results.clear();
+  }
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::trace_intersections()
 {
   // scan 3-simplices to get connected components
   union_find<element_t> uf;
-  for (const auto &kv : discrete_critical_points) 
-    uf.add(kv.first);
+  for (const auto &kv : discrete_critical_points) {
+    element_t e(3, 2);
+    e.from_integer(m, kv.first);
+    uf.add(e);
+  }
 
   m.element_for(3, [&](const regular_simplex_mesh_element& f) {
     const auto sides = f.sides(m);
@@ -359,116 +613,163 @@ inline void critical_point_tracker_2d_regular::trace_intersections()
       }
     }
   });
-  uf.get_sets(connected_components);
+
+  std::vector<std::set<element_t>> components;
+  uf.get_sets(components);
+  for (const auto &component : components) {
+    std::vector<uint64_t> component_ids;
+    for (const auto &e : component)
+      component_ids.push_back(e.to_integer(m));
+    connected_components.emplace_back(component_ids);
+  }
 }
 
-inline void critical_point_tracker_2d_regular::trace_connected_components()
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::trace_connected_components(bool closed_only)
 {
-  // Convert connected components to geometries
-  auto neighbors = [&](element_t f) {
-    std::set<element_t> neighbors;
-    const auto cells = f.side_of(m);
-    for (const auto c : cells) {
-      const auto elements = c.sides(m);
-      for (const auto f1 : elements)
-        neighbors.insert(f1);
-    }
-    return neighbors;
+  // element ids of discrete critical points in ascending order
+  std::vector<uint64_t> ids;
+  ids.reserve(discrete_critical_points.size());
+  for (const auto &kv : discrete_critical_points)
+    ids.push_back(kv.first);
+  std::sort(ids.begin(), ids.end());
+
+  // nodes of the graph are indices in ids
+  const auto graph = m.element_adjacency<3>(2, ids);
+  const auto components = extract_connected_components(graph);
+
+  // a component is open if any of its simplices reaches the timesteps that 
+  // later scans will touch
+  auto is_open = [&](size_t i) {
+    fixed_element_t e(2);
+    e.from_integer(m, ids[i]);
+    int vertices[3][3];
+    e.vertices(m, vertices);
+    for (int j = 0; j < 3; j ++)
+      if (vertices[j][2] > current_timestep) return true;
+    return false;
   };
 
-  std::set<element_t> elements;
-  for (const auto &kv : discrete_critical_points)
-    elements.insert(kv.first);
-  connected_components = extract_connected_components<element_t, std::set<element_t>>(
-      neighbors, elements);
+  for (const auto &component : components) {
+    if (closed_only && std::any_of(component.begin(), component.end(), is_open))
+      continue;
+
+    if (!use_streaming_trajectories) {
+      std::vector<uint64_t> component_ids;
+      for (auto i : component)
+        component_ids.push_back(ids[i]);
+      connected_components.emplace_back(component_ids);
+    }
 
-  for (const auto &component : connected_components) {
-    std::vector<std::vector<double>> mycurves;
-    auto linear_graphs = ftk::connected_component_to_linear_components<element_t>(component, neighbors);
+    auto linear_graphs = connected_component_to_linear_components(component, graph);
     for (int j = 0; j < linear_graphs.size(); j ++) {
       std::vector<critical_point_2dt_t> traj; 
       for (int k = 0; k < linear_graphs[j].size(); k ++)
-        traj.push_back(discrete_critical_points[linear_graphs[j][k]]);
-      traced_critical_points.emplace_back(traj);
+        traj.push_back(discrete_critical_points[ids[linear_graphs[j][k]]]);
+
+      if (trajectory_callback) trajectory_callback(traj);
+      else traced_critical_points.emplace_back(traj);
     }
+
+    if (closed_only)
+      for (auto i : component)
+        discrete_critical_points.erase(ids[i]);
   }
 }
 
+template <typename T>
 template <typename I>
-inline void critical_point_tracker_2d_regular::simplex_indices(
-    const std::vector<std::vector<int>>& vertices, I indices[]) const
+inline void critical_point_tracker_2d_regular_t<T>::simplex_indices(
+    int n, const int vertices[][3], I indices[]) const
 {
-  for (int i = 0; i < vertices.size(); i ++)
+  for (int i = 0; i < n; i ++)
     indices[i] = m.get_lattice().to_integer(vertices[i]);
 }
 
-inline void critical_point_tracker_2d_regular::simplex_coordinates(
-    const std::vector<std::vector<int>>& vertices, double X[][3]) const
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::simplex_coordinates(
+    int n, const int vertices[][3], double X[][3]) const
 {
   if (use_explicit_coords) {
-    for (int i = 0; i < vertices.size(); i ++) {
+    for (int i = 0; i < n; i ++) {
       for (int j = 0; j < 2; j ++) 
         X[i][j] = coords(j, vertices[i][0], vertices[i][1]);
       X[i][2] = vertices[i][2];
     }
   } else {
-    for (int i = 0; i < vertices.size(); i ++)
+    for (int i = 0; i < n; i ++)
       for (int j = 0; j < 3; j ++)
         X[i][j] = vertices[i][j];
   }
 }
 
 template <typename T>
-inline void critical_point_tracker_2d_regular::simplex_vectors(
-    const std::vector<std::vector<int>>& vertices, T v[][2]) const
+template <typename T1>
+inline void critical_point_tracker_2d_regular_t<T>::simplex_vectors(
+    int n, const int vertices[][3], T1 v[][2]) const
 {
-  for (int i = 0; i < vertices.size(); i ++) {
-    const int iv = vertices[i][2] == current_timestep ? 0 : 1;
+  const int x0 = local_array_domain.start(0), 
+            y0 = local_array_domain.start(1);
+  for (int i = 0; i < n; i ++) {
+    const auto &V = snapshot_fields[vertices[i][2] == current_timestep ? 0 : 1].vector;
     for (int j = 0; j < 2; j ++)
-      v[i][j] = field_data_snapshots[iv].vector(j, 
-          vertices[i][0] - local_array_domain.start(0), 
-          vertices[i][1] - local_array_domain.start(1));
+      v[i][j] = V(j, vertices[i][0] - x0, vertices[i][1] - y0);
   }
 }
 
-inline void critical_point_tracker_2d_regular::simplex_scalars(
-    const std::vector<std::vector<int>>& vertices, double values[]) const
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::simplex_scalars(
+    int n, const int vertices[][3], double values[]) const
 {
-  for (int i = 0; i < vertices.size(); i ++) {
-    const int iv = vertices[i][2] == current_timestep ? 0 : 1;
-    values[i] = field_data_snapshots[iv].scalar(
-        vertices[i][0] - local_array_domain.start(0), 
-        vertices[i][1] - local_array_domain.start(1));
+  const int x0 = local_array_domain.start(0), 
+            y0 = local_array_domain.start(1);
+  for (int i = 0; i < n; i ++) {
+    const auto &S = snapshot_fields[vertices[i][2] == current_timestep ? 0 : 1].scalar;
+    values[i] = S(vertices[i][0] - x0, vertices[i][1] - y0);
   }
 }
 
-inline void critical_point_tracker_2d_regular::simplex_jacobians(
-    const std::vector<std::vector<int>>& vertices, 
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::simplex_jacobians(
+    int n, const int vertices[][3], 
     double Js[][2][2]) const
 {
-  for (int i = 0; i < vertices.size(); i ++) {
+  const int x0 = local_array_domain.start(0), 
+            y0 = local_array_domain.start(1);
+  const int gw = is_input_array_partial ? array_domain.size(0) : 0, 
+            gh = is_input_array_partial ? array_domain.size(1) : 0;
+  for (int i = 0; i < n; i ++) {
     const int iv = vertices[i][2] == current_timestep ? 0 : 1;
-    for (int j = 0; j < 2; j ++) {
-      for (int k = 0; k < 2; k ++) {
-        Js[i][j][k] = field_data_snapshots[iv].jacobian(k, j, 
-            vertices[i][0] - local_array_domain.start(0), 
-            vertices[i][1] - local_array_domain.start(1));
-      }
+    const auto &s = field_data_snapshots[iv];
+    const int x = vertices[i][0] - x0, 
+              y = vertices[i][1] - y0;
+
+    if (s.jacobian_cache) { // lazy
+      const auto J = s.jacobian_cache->get(x + y * s.vector.dim(1), 
+          [&](std::array<T, 9>& J) {jacobian2D(s.vector, x, y, (T (*)[2])J.data(), gw, gh);});
+      for (int j = 0; j < 2; j ++)
+        for (int k = 0; k < 2; k ++)
+          Js[i][j][k] = J[k*2+j];
+    } else {
+      for (int j = 0; j < 2; j ++)
+        for (int k = 0; k < 2; k ++)
+          Js[i][j][k] = snapshot_fields[iv].jacobian(k, j, x, y);
     }
   }
 }
 
-inline bool critical_point_tracker_2d_regular::check_simplex(
-    const regular_simplex_mesh_element& e,
+template <typename T>
+inline bool critical_point_tracker_2d_regular_t<T>::check_simplex(
+    const fixed_element_t& e,
+    const int vertices[][3], // vertices of the simplex
     critical_point_2dt_t& cp)
 {
   typedef fixed_point<> fp_t;
   
   if (!e.valid(m)) return false; // check if the 2-simplex is valid
-  const auto &vertices = e.vertices(m); // obtain the vertices of the simplex
  
   double v[3][2]; // obtain vector values
-  simplex_vectors(vertices, v);
+  simplex_vectors(3, vertices, v);
 
 #if 0 // working in progress, handling degeneracy cases
   fp_t vf[3][2];
@@ -506,7 +807,7 @@ inline bool critical_point_tracker_2d_regular::check_simplex(
     for (int j = 0; j < 2; j ++)
       vf[i][j] = v[i][j];
   int indices[3];
-  simplex_indices(vertices, indices);
+  simplex_indices(3, vertices, indices);
   // bool succ = robust_critical_point_in_simplex2(vf, indices);
   // if (!succ) return false;
 
@@ -514,20 +815,51 @@ inline bool critical_point_tracker_2d_regular::check_simplex(
   bool succ2 = inverse_lerp_s2v2(v, mu);
   if (!succ2) return false;
 
+  interpolate_critical_point(vertices, mu, cp);
+  return true;
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::check_simplex_batch(
+    simplex_batch_t<3>& b, int tid)
+{
+  if (b.n == 0) return;
+  b.pad();
+
+  const int W = simplex_batch_t<3>::width;
+  double mu[3][W];
+  int succ[W];
+  inverse_lerp_s2v2_batch<W>(b.V, mu, succ);
+
+  for (int k = 0; k < b.n; k ++) {
+    if (!succ[k]) continue;
+    const double mu1[3] = {mu[0][k], mu[1][k], mu[2][k]};
+    critical_point_2dt_t cp;
+    interpolate_critical_point(b.vertices[k], mu1, cp);
+    if (filter_critical_point_type(cp))
+      thread_critical_points[tid].push_back(std::make_pair(b.elements[k].to_integer(m), cp));
+  }
+  b.n = 0;
+}
+
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::interpolate_critical_point(
+    const int vertices[][3], const double mu[3], critical_point_2dt_t& cp) const
+{
   double X[3][3]; // position
-  simplex_coordinates(vertices, X);
+  simplex_coordinates(3, vertices, X);
   lerp_s2v3(X, mu, cp.x);
 
   if (scalar_field_source != SOURCE_NONE) {
     double values[3];
-    simplex_scalars(vertices, values);
+    simplex_scalars(3, vertices, values);
     cp.scalar = lerp_s2(values, mu);
   }
 
   double J[2][2] = {0}; // jacobian
   if (jacobian_field_source != SOURCE_NONE) { // lerp jacobian
     double Js[3][2][2];
-    simplex_jacobians(vertices, Js);
+    simplex_jacobians(3, vertices, Js);
     lerp_s2m2x2(Js, mu, J);
     ftk::make_symmetric2x2(J); // TODO
   } else {
@@ -542,19 +874,17 @@ inline bool critical_point_tracker_2d_regular::check_simplex(
   ftk::make_symmetric2x2(J); // TODO
 #endif
   cp.type = critical_point_type_2d(J, is_jacobian_field_symmetric);
-
-  return true;
 } 
 
-inline bool critical_point_tracker_2d_regular::robust_check_simplex0(const element_t& e, critical_point_2dt_t& cp)
+template <typename T>
+inline bool critical_point_tracker_2d_regular_t<T>::robust_check_simplex0(const fixed_element_t& e, const int vertices[][3], critical_point_2dt_t& cp)
 {
   typedef fixed_point<> fp_t;
 
   if (!e.valid(m)) return false; // check if the 2-simplex is valid
-  const auto &vertices = e.vertices(m); // obtain the vertices of the simplex
 
   fp_t v[1][2]; // obtain vector values
-  simplex_vectors<fp_t>(vertices, v);
+  simplex_vectors<fp_t>(1, vertices, v);
 
   if (v[0][0] == 0 && v[0][1] == 0) {
     fprintf(stderr, "zero!\n");
@@ -570,19 +900,19 @@ inline bool critical_point_tracker_2d_regular::robust_check_simplex0(const eleme
 #endif
 }
 
-inline bool critical_point_tracker_2d_regular::robust_check_simplex1(const element_t& e, critical_point_2dt_t& cp)
+template <typename T>
+inline bool critical_point_tracker_2d_regular_t<T>::robust_check_simplex1(const fixed_element_t& e, const int vertices[][3], critical_point_2dt_t& cp)
 {
   typedef fixed_point<> fp_t;
 
   if (!e.valid(m)) return false; // check if the 2-simplex is valid
-  const auto &vertices = e.vertices(m); // obtain the vertices of the simplex
 
   // fp_t v[2][2]; // obtain vector values
   // simplex_vectors<fp_t>(vertices, v);
  
   double V[2][2];
   long long iV[2][2];
-  simplex_vectors(vertices, V);
+  simplex_vectors(2, vertices, V);
   for (int i = 0; i < 2; i ++)
     for (int j = 0; j < 2; j ++)
       iV[i][j] = V[i][j] * 32768;
@@ -602,7 +932,8 @@ inline bool critical_point_tracker_2d_regular::robust_check_simplex1(const eleme
 }
 
 #if 0
-void critical_point_tracker_2d_regular::robust_check_simplex2(const element_t& s, critical_point_2dt_t& cp)
+template <typename T>
+void critical_point_tracker_2d_regular_t<T>::robust_check_simplex2(const element_t& s, critical_point_2dt_t& cp)
 {
   if (!e.valid(m)) return false; // check if the 2-simplex is valid
   const auto &vertices = e.vertices(m); // obtain the vertices of the simplex
@@ -621,7 +952,8 @@ void critical_point_tracker_2d_regular::robust_check_simplex2(const element_t& s
 #endif
 
 #if FTK_HAVE_VTK
-inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular::get_traced_critical_points_vtk() const
+template <typename T>
+inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular_t<T>::get_traced_critical_points_vtk() const
 {
   vtkSmartPointer<vtkPolyData> polyData = vtkPolyData::New();
   vtkSmartPointer<vtkPoints> points = vtkPoints::New();
@@ -689,7 +1021,8 @@ inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular::get_trace
   return polyData;
 }
 
-inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular::get_discrete_critical_points_vtk() const
+template <typename T>
+inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular_t<T>::get_discrete_critical_points_vtk() const
 {
   vtkSmartPointer<vtkPolyData> polyData = vtkPolyData::New();
   vtkSmartPointer<vtkPoints> points = vtkPoints::New();
@@ -731,17 +1064,20 @@ inline vtkSmartPointer<vtkPolyData> critical_point_tracker_2d_regular::get_discr
 }
 #endif
 
-inline void critical_point_tracker_2d_regular::write_discrete_critical_points(const std::string& filename) const
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::write_discrete_critical_points(const std::string& filename) const
 {
   diy::serializeToFile(discrete_critical_points, filename);
 }
 
-inline void critical_point_tracker_2d_regular::write_traced_critical_points(const std::string& filename) const 
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::write_traced_critical_points(const std::string& filename) const 
 {
   diy::serializeToFile(traced_critical_points, filename);
 }
 
-inline void critical_point_tracker_2d_regular::write_traced_critical_points_text(std::ostream& os) const
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::write_traced_critical_points_text(std::ostream& os) const
 {
   os << "#trajectories=" << traced_critical_points.size() << std::endl;
   for (int i = 0; i < traced_critical_points.size(); i ++) {
@@ -755,7 +1091,8 @@ inline void critical_point_tracker_2d_regular::write_traced_critical_points_text
   }
 }
 
-inline void critical_point_tracker_2d_regular::write_discrete_critical_points_text(std::ostream& os) const
+template <typename T>
+inline void critical_point_tracker_2d_regular_t<T>::write_discrete_critical_points_text(std::ostream& os) const
 {
   for (const auto &kv : discrete_critical_points) {
     const auto &cp = kv.second;
@@ -3,8 +3,13 @@
 
 #include <ftk/ndarray.hh>
 #include <ftk/hypermesh/lattice_partitioner.hh>
+#include <ftk/hypermesh/regular_simplex_mesh.hh>
 #include <ftk/filters/critical_point_tracker.hh>
+#include <ftk/basic/distributed_union_find.hh>
 #include <ftk/external/diy-ext/gather.hh>
+#include <ftk/external/diy-ext/redistribute.hh>
+#include <unordered_map>
+#include <cstdint>
 
 namespace ftk {
 
@@ -29,16 +34,60 @@ struct critical_point_tracker_regular : public critical_point_tracker {
   void set_local_domain(const lattice&); // rank-specific "core" region of the block
   void set_local_array_domain(const lattice&); // rank-specific "ext" region of the block
 
+  // With partial input arrays, every rank is pushed only the block of the 
+  // array domain that is returned here after initialize(), i.e. its core 
+  // with ghost layers that are wide enough to derive the gradient and 
+  // jacobian fields; otherwise the whole array domain.
+  const lattice& get_local_array_domain() const {return local_array_domain;}
+
   void set_scalar_field_source(int s) {scalar_field_source = s;}
   void set_vector_field_source(int s) {vector_field_source = s;}
   void set_jacobian_field_source(int s) {jacobian_field_source = s;}
   void set_jacobian_symmetric(bool s) {is_jacobian_field_symmetric = s;}
 
-  virtual void push_scalar_field_snapshot(const ndarray<double>&) = 0;
+  // A derived jacobian field is not stored in the snapshots but evaluated 
+  // at the vertices of the simplices that contain critical points; only 
+  // supported by the CPU path
+  void set_jacobian_field_lazy(bool b) {use_lazy_jacobian_field = b;}
+
   virtual void push_vector_field_snapshot(const ndarray<double>&) = 0;
+  virtual void push_vector_field_snapshot(const ndarray<float>&) = 0;
+  virtual void push_vector_field_snapshot(ndarray<double>&&) = 0;
+  virtual void push_vector_field_snapshot(ndarray<float>&&) = 0;
 
   void set_type_filter(unsigned int);
 
+  // In the streaming mode, discrete critical points are gathered and traced 
+  // at every timestep; trajectories that cannot be extended by later 
+  // timesteps are completed right away and removed from the working set.
+  void set_streaming_trajectories(bool b) {use_streaming_trajectories = b;}
+
+  // Otherwise with multiple procs, connected components are labeled with the 
+  // distributed union-find and traced on the procs that own them; only the 
+  // traced trajectories are gathered to the root proc, while discrete 
+  // critical points stay distributed.
+
+  // With multiple procs and the default domain partition, the cores of the 
+  // procs are recomputed every n timesteps (0 for never) by weighted 
+  // bisection on the cost of the CPU path in the timesteps since, so that 
+  // clusters of critical points are spread over more procs.  Discrete 
+  // critical points and partial input arrays move to the new cores.
+  void set_rebalance_interval(int n) {rebalance_interval = n;}
+
+  // Temporal decomposition for offline tracking: the procs are divided into 
+  // n groups of consecutive ranks, every group tracks a window of the 
+  // timesteps [start_timestep, end_timestep] (the end timestep must be 
+  // set) with the default domain partition among its procs, and adjacent 
+  // windows overlap by one timestep.  Connected components are stitched 
+  // across windows in finalize().  Not supported with streaming 
+  // trajectories or rebalancing.
+  void set_number_of_time_windows(int n) {ntime_windows = n;}
+
+  // the first and the last (inclusive) timesteps to push to this proc 
+  // after initialize(), which also sets the current timestep to the first
+  int get_local_start_timestep() const {return local_start_timestep;}
+  int get_local_end_timestep() const {return local_end_timestep;}
+
   virtual void initialize() = 0;
   virtual void finalize() = 0;
 
@@ -64,7 +113,105 @@ struct critical_point_tracker_regular : public critical_point_tracker {
 
 protected:
   template <int N, typename T=double>
-  bool filter_critical_point_type(const critical_point_t<N, T>& cp);
+  bool filter_critical_point_type(const critical_point_t<N, T>& cp) const;
+
+  // sets the time window of this proc, and returns the number of procs and 
+  // the rank of this proc for the spatial partition
+  void partition_time_windows(int& np, int& rank);
+
+  // if the current timestep is scanned by this proc; the last timestep of 
+  // a window is scanned by the next window
+  bool scanning_timestep() const {return current_timestep < local_end_timestep || local_end_timestep == end_timestep;}
+
+  // the block of the array domain that covers the spatial dims of core and 
+  // the given numbers of ghost layers on both sides
+  lattice partial_array_domain(const lattice& core, size_t ghost_low, size_t ghost_high) const;
+
+  // Rebalancing.  The cost is kept on bins of cost_bin_size^nd vertices of 
+  // the domain: the time to scan the core in a timestep is spread over its 
+  // bins, half by volume and half by the candidate cubes of the bins.
+  enum {cost_bin_size = 8};
+  bool rebalancing() const {return rebalance_interval > 0 && comm.size() > 1 && use_default_domain_partition && ntime_windows == 1;}
+  template <int ND>
+  void count_candidate_cubes(const std::vector<std::array<int, ND>>& corners);
+  void add_cost(double seconds);
+
+  virtual void rebalance() {} // called by advance_timestep
+  bool repartition(); // updates the local domains; false if no core changes
+
+  // cores of all procs, i.e. starts and sizes followed by the first and the 
+  // last timesteps of the time windows, and if a core contains a corner, of 
+  // which the time may be out of the time window by up to slack timesteps
+  std::vector<std::vector<int>> gather_local_domains() const;
+  static bool core_contains(const std::vector<int>& core, const int corner[], int slack = 0);
+  static int core_owner(const std::vector<std::vector<int>>& cores, const int corner[]);
+
+  // moves critical points to the procs whose cores contain their corners
+  template <int ND, typename CP>
+  void migrate_critical_points(const regular_simplex_mesh& m, int d, 
+      std::unordered_map<uint64_t, CP>& discrete_critical_points);
+
+  // moves the parts of arrays, of which the last dimensions are the blocks 
+  // old_block of the procs, to the local_array_domain of the procs
+  template <typename T>
+  void migrate_array(ndarray<T>& a, const lattice& old_block) const;
+
+  // moves the given fields of a partial snapshot to the new blocks, and 
+  // clears the derived fields so that they can be derived again
+  template <typename T>
+  void migrate_field_data(field_data_snapshot_t<T>& s, const lattice& old_block, 
+      field_data_buffer_pool_t<T>& buffers) const;
+
+  // Cube-level quick reject: appends to corners the spacetime cubes of the 
+  // lattice l (one timestep thick) that may contain a zero of the vector 
+  // field.  The min/max pyramids of the snapshots (see minmax_pyramid) 
+  // prune bricks of cubes in which a component keeps a strict sign, and 
+  // the cubes of the remaining bricks are tested by the signs of their 
+  // vertices.  Vertices at current_timestep are read from s0 and others 
+  // from s1, the same as the simplex_vectors() of the trackers; in the 
+  // ordinal scope only the vertices of the first timestep are tested.
+  template <int ND, typename T>
+  void candidate_cubes(const lattice& l, int scope, 
+      const field_data_snapshot_t<T>& s0, const field_data_snapshot_t<T>& s1, 
+      std::vector<std::array<int, ND>>& corners) const;
+
+  // Simplices that are gathered per thread for the batched inverse 
+  // interpolation: element, vertices, and the ND-1 components of the vector 
+  // field on each of the ND vertices in structure-of-arrays layout
+  template <int ND>
+  struct simplex_batch_t {
+    enum {width = 8};
+
+    bool full() const {return n == width;}
+    void push(const regular_simplex_mesh_fixed_element<ND>& e, const int vertices_[][ND], const double v[][ND-1]) {
+      elements[n] = e;
+      for (int i = 0; i < ND; i ++) {
+        for (int j = 0; j < ND; j ++)
+          vertices[n][i][j] = vertices_[i][j];
+        for (int j = 0; j < ND-1; j ++)
+          V[i][j][n] = v[i][j];
+      }
+      n ++;
+    }
+    void pad() { // fills unused lanes with the first simplex
+      for (int k = n; k < width; k ++)
+        for (int i = 0; i < ND; i ++)
+          for (int j = 0; j < ND-1; j ++)
+            V[i][j][k] = V[i][j][0];
+    }
+
+    int n = 0;
+    regular_simplex_mesh_fixed_element<ND> elements[width];
+    int vertices[width][ND][ND];
+    double V[ND][ND-1][width];
+  };
+
+  // Labels the connected components of the discrete critical points 
+  // (d-simplices of m in the local core) across procs, and moves every 
+  // component entirely to one proc
+  template <int ND, typename CP>
+  void redistribute_connected_components(const regular_simplex_mesh& m, int d, 
+      std::unordered_map<uint64_t, CP>& discrete_critical_points);
 
 protected: // config
   lattice domain, array_domain, 
@@ -82,8 +229,15 @@ protected: // config
       jacobian_field_source = SOURCE_NONE;
   bool use_explicit_coords = false;
   bool is_jacobian_field_symmetric = false;
+  bool use_lazy_jacobian_field = false;
   bool use_type_filter = false;
   unsigned int type_filter = 0;
+  bool use_streaming_trajectories = false;
+  int rebalance_interval = 0;
+  int ntime_windows = 1;
+  int local_start_timestep = 0, 
+      local_end_timestep = std::numeric_limits<int>::max();
+  std::vector<double> cost, bin_candidates; // per bin, since the last rebalancing
 
 protected:
   ndarray<double> coords;
@@ -98,7 +252,298 @@ inline bool critical_point_tracker_regular::advance_timestep()
   pop_field_data_snapshot();
 
   current_timestep ++;
-  return field_data_snapshots.size() > 0; // > 0;
+  if (rebalancing() && current_timestep % rebalance_interval == 0)
+    rebalance();
+  return num_field_data_snapshots() > 0; // > 0;
+}
+
+inline void critical_point_tracker_regular::set_start_timestep(int t)
+{
+  start_timestep = t;
+}
+
+inline void critical_point_tracker_regular::set_end_timestep(int t)
+{
+  end_timestep = t;
+}
+
+inline void critical_point_tracker_regular::partition_time_windows(int& np, int& rank)
+{
+  local_start_timestep = start_timestep;
+  local_end_timestep = end_timestep;
+  np = comm.size();
+  rank = comm.rank();
+  if (ntime_windows <= 1) return;
+
+  if (use_streaming_trajectories || !use_default_domain_partition) {
+    fprintf(stderr, "[FTK] fatal: time windows need the default domain partition and no streaming trajectories.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (end_timestep == std::numeric_limits<int>::max()) {
+    fprintf(stderr, "[FTK] fatal: the end timestep must be set for time windows.\n");
+    exit(EXIT_FAILURE);
+  }
+  const long nt = static_cast<long>(end_timestep) - start_timestep; // intervals
+  if (comm.size() % ntime_windows != 0 || nt < ntime_windows) {
+    fprintf(stderr, "[FTK] fatal: cannot divide %d procs and %ld timestep intervals into %d time windows.\n", 
+        comm.size(), nt, ntime_windows);
+    exit(EXIT_FAILURE);
+  }
+
+  np = comm.size() / ntime_windows;
+  rank = comm.rank() % np;
+  const long w = comm.rank() / np;
+  local_start_timestep = start_timestep + w * nt / ntime_windows;
+  local_end_timestep = start_timestep + (w + 1) * nt / ntime_windows;
+  current_timestep = local_start_timestep;
+}
+
+inline lattice critical_point_tracker_regular::partial_array_domain(
+    const lattice& core, size_t ghost_low, size_t ghost_high) const
+{
+  std::vector<size_t> starts(array_domain.nd()), sizes(array_domain.nd());
+  for (size_t i = 0; i < array_domain.nd(); i ++) {
+    const size_t lb = array_domain.start(i), 
+                 ub = array_domain.start(i) + array_domain.size(i); // exclusive
+    const size_t s = core.start(i) - std::min(core.start(i) - lb, ghost_low), 
+                 e = std::min(core.start(i) + core.size(i) + ghost_high, ub);
+    starts[i] = s;
+    sizes[i] = e - s;
+  }
+  return lattice(starts, sizes);
+}
+
+template <int ND>
+inline void critical_point_tracker_regular::count_candidate_cubes(
+    const std::vector<std::array<int, ND>>& corners)
+{
+  const int nd = ND - 1;
+  size_t n = 1;
+  for (int i = 0; i < nd; i ++)
+    n *= (domain.size(i) + cost_bin_size - 1) / cost_bin_size;
+  bin_candidates.resize(n, 0.0);
+
+  for (const auto &c : corners) {
+    size_t idx = 0, stride = 1;
+    for (int i = 0; i < nd; i ++) {
+      idx += (c[i] - domain.start(i)) / cost_bin_size * stride;
+      stride *= (domain.size(i) + cost_bin_size - 1) / cost_bin_size;
+    }
+    bin_candidates[idx] += 1;
+  }
+}
+
+inline void critical_point_tracker_regular::add_cost(double seconds)
+{
+  const int nd = domain.nd();
+  std::vector<size_t> nbins(nd), b0(nd), b1(nd);
+  size_t n = 1, volume = 1;
+  for (int i = 0; i < nd; i ++) {
+    nbins[i] = (domain.size(i) + cost_bin_size - 1) / cost_bin_size;
+    n *= nbins[i];
+    volume *= local_domain.size(i);
+    b0[i] = (local_domain.start(i) - domain.start(i)) / cost_bin_size;
+    b1[i] = (local_domain.start(i) + local_domain.size(i) - 1 - domain.start(i)) / cost_bin_size + 1;
+  }
+  cost.resize(n, 0.0);
+  bin_candidates.resize(n, 0.0);
+  const double ncandidates = std::accumulate(bin_candidates.begin(), bin_candidates.end(), 0.0);
+
+  // bins that overlap the core
+  std::vector<size_t> b(b0);
+  while (volume > 0) {
+    size_t idx = 0, stride = 1, overlap = 1;
+    for (int i = 0; i < nd; i ++) {
+      const size_t lo = std::max(domain.start(i) + b[i] * cost_bin_size, local_domain.start(i)), 
+                   hi = std::min(domain.start(i) + (b[i] + 1) * cost_bin_size, local_domain.start(i) + local_domain.size(i));
+      overlap *= hi - lo;
+      idx += b[i] * stride;
+      stride *= nbins[i];
+    }
+    const double v = double(overlap) / volume, 
+                 c = ncandidates > 0 ? bin_candidates[idx] / ncandidates : v;
+    cost[idx] += seconds * 0.5 * (v + c);
+
+    int i = 0;
+    for (; i < nd; i ++) {
+      if (++ b[i] < b1[i]) break;
+      else b[i] = b0[i];
+    }
+    if (i == nd) break;
+  }
+  std::fill(bin_candidates.begin(), bin_candidates.end(), 0.0);
+}
+
+inline bool critical_point_tracker_regular::repartition()
+{
+  // costs are summed in the order of procs, so that all procs get the 
+  // same partition
+  std::vector<std::vector<double>> costs;
+  diy::mpi::all_gather(comm, cost, costs);
+  std::vector<double> total;
+  for (const auto &c : costs) {
+    total.resize(std::max(total.size(), c.size()), 0.0);
+    for (size_t i = 0; i < c.size(); i ++)
+      total[i] += c[i];
+  }
+  std::fill(cost.begin(), cost.end(), 0.0);
+  if (std::accumulate(total.begin(), total.end(), 0.0) <= 0) return false;
+
+  lattice_partitioner partitioner(domain);
+  partitioner.partition_weighted(comm.size(), total, cost_bin_size, {}, {});
+  if (static_cast<int>(partitioner.np()) != comm.size()) return false;
+
+  const lattice core = partitioner.get_core(comm.rank());
+  int changed = core.starts() != local_domain.starts() || core.sizes() != local_domain.sizes(), nchanged = 0;
+  diy::mpi::all_reduce(comm, changed, nchanged, std::plus<int>());
+  if (nchanged == 0) return false;
+
+  local_domain = core;
+  if (is_input_array_partial)
+    local_array_domain = partial_array_domain(local_domain, 2, 3);
+  return true;
+}
+
+inline std::vector<std::vector<int>> critical_point_tracker_regular::gather_local_domains() const
+{
+  std::vector<int> core;
+  for (size_t i = 0; i < local_domain.nd(); i ++) core.push_back(local_domain.start(i));
+  for (size_t i = 0; i < local_domain.nd(); i ++) core.push_back(local_domain.size(i));
+  core.push_back(local_start_timestep);
+  core.push_back(local_end_timestep);
+  std::vector<std::vector<int>> cores;
+  diy::mpi::all_gather(comm, core, cores);
+  return cores;
+}
+
+inline bool critical_point_tracker_regular::core_contains(
+    const std::vector<int>& core, const int corner[], int slack)
+{
+  const size_t nd = core.size() / 2 - 1;
+  for (size_t i = 0; i < nd; i ++)
+    if (corner[i] < core[i] || corner[i] >= core[i] + core[nd+i]) return false;
+  return corner[nd] >= core[2*nd] - slack && corner[nd] - slack <= core[2*nd+1];
+}
+
+inline int critical_point_tracker_regular::core_owner(
+    const std::vector<std::vector<int>>& cores, const int corner[])
+{
+  for (size_t p = 0; p < cores.size(); p ++)
+    if (core_contains(cores[p], corner)) return p;
+  return -1;
+}
+
+template <int ND, typename CP>
+inline void critical_point_tracker_regular::migrate_critical_points(
+    const regular_simplex_mesh& m, int d, 
+    std::unordered_map<uint64_t, CP>& discrete_critical_points)
+{
+  const auto cores = gather_local_domains();
+  std::vector<std::vector<std::pair<uint64_t, CP>>> outgoing(comm.size());
+  for (const auto &kv : discrete_critical_points) {
+    regular_simplex_mesh_fixed_element<ND> e(d);
+    e.from_integer(m, kv.first);
+    const int p = core_owner(cores, e.corner.data());
+    outgoing[p >= 0 ? p : comm.rank()].push_back(kv);
+  }
+  diy::mpi::redistribute(comm, outgoing, outgoing);
+
+  discrete_critical_points.clear();
+  for (const auto &cps : outgoing)
+    discrete_critical_points.insert(cps.begin(), cps.end());
+}
+
+template <typename T>
+inline void critical_point_tracker_regular::migrate_array(ndarray<T>& a, const lattice& old_block) const
+{
+  if (a.empty()) return; // on all procs
+  const int np = comm.size(), nd = old_block.nd();
+  auto gather = [&](const lattice& l) {
+    std::vector<int> b;
+    for (int i = 0; i < nd; i ++) b.push_back(l.start(i));
+    for (int i = 0; i < nd; i ++) b.push_back(l.size(i));
+    std::vector<std::vector<int>> bs;
+    diy::mpi::all_gather(comm, b, bs);
+    return bs;
+  };
+  const auto olds = gather(old_block), news = gather(local_array_domain);
+
+  // intersection of the blocks b0 and b1, false if empty
+  auto intersect = [&](const std::vector<int>& b0, const std::vector<int>& b1, 
+      std::vector<size_t>& starts, std::vector<size_t>& sizes) {
+    for (int i = 0; i < nd; i ++) {
+      const int lo = std::max(b0[i], b1[i]), 
+                hi = std::min(b0[i] + b0[nd+i], b1[i] + b1[nd+i]);
+      if (lo >= hi) return false;
+      starts[i] = lo;
+      sizes[i] = hi - lo;
+    }
+    return true;
+  };
+
+  // the first dimensions of the arrays are components
+  const int nc = a.nd() - nd;
+  const std::vector<size_t> dims = a.shape();
+  std::vector<size_t> shape(dims.begin(), dims.begin() + nc);
+  for (int i = 0; i < nd; i ++)
+    shape.push_back(local_array_domain.size(i));
+  
+  std::vector<std::vector<T>> outgoing(np);
+  std::vector<size_t> starts(nd), sizes(nd);
+  for (int p = 0; p < np; p ++) {
+    if (!intersect(olds[comm.rank()], news[p], starts, sizes)) continue;
+    std::vector<size_t> st(nc, 0), sz(dims.begin(), dims.begin() + nc);
+    for (int i = 0; i < nd; i ++) {
+      st.push_back(starts[i] - old_block.start(i));
+      sz.push_back(sizes[i]);
+    }
+    const auto v = a.view().slice(st, sz);
+    outgoing[p].resize(v.nelem());
+    v.copy_to(outgoing[p].data());
+  }
+  diy::mpi::redistribute(comm, outgoing, outgoing);
+
+  // rows along the first spatial dimension
+  ndarray<T> b(shape);
+  size_t ncomponents = 1;
+  for (int i = 0; i < nc; i ++)
+    ncomponents *= shape[i];
+  for (int p = 0; p < np; p ++) {
+    if (!intersect(olds[p], news[comm.rank()], starts, sizes)) continue;
+    const size_t row = sizes[0] * ncomponents;
+    const T *in = outgoing[p].data();
+    std::vector<size_t> x(nd, 0);
+    while (1) {
+      size_t offset = 0;
+      for (int i = nd - 1; i >= 0; i --)
+        offset = offset * local_array_domain.size(i) + starts[i] - local_array_domain.start(i) + x[i];
+      std::copy(in, in + row, b.data() + offset * ncomponents);
+      in += row;
+
+      int i = 1;
+      for (; i < nd; i ++) {
+        if (++ x[i] < sizes[i]) break;
+        else x[i] = 0;
+      }
+      if (i >= nd) break;
+    }
+  }
+  a = std::move(b);
+}
+
+template <typename T>
+inline void critical_point_tracker_regular::migrate_field_data(
+    field_data_snapshot_t<T>& s, const lattice& old_block, 
+    field_data_buffer_pool_t<T>& buffers) const
+{
+  if (scalar_field_source == SOURCE_GIVEN) migrate_array(s.scalar, old_block);
+  else buffers.put(s.scalar);
+  if (vector_field_source == SOURCE_GIVEN) migrate_array(s.vector, old_block);
+  else buffers.put(s.vector);
+  if (jacobian_field_source == SOURCE_GIVEN) migrate_array(s.jacobian, old_block);
+  else buffers.put(s.jacobian);
+  s.vector_bounds.clear();
+  s.jacobian_cache.reset();
 }
 
 inline void critical_point_tracker_regular::set_type_filter(unsigned int f)
@@ -109,7 +554,7 @@ inline void critical_point_tracker_regular::set_type_filter(unsigned int f)
   
 template <int N, typename T>
 inline bool critical_point_tracker_regular::filter_critical_point_type(
-    const critical_point_t<N, T>& cp)
+    const critical_point_t<N, T>& cp) const
 {
   // fprintf(stderr, "typefilter=%lu, type=%lu\n", 
   //     type_filter, cp.type);
@@ -120,6 +565,258 @@ inline bool critical_point_tracker_regular::filter_critical_point_type(
   else return true;
 }
 
+template <int ND, typename T>
+inline void critical_point_tracker_regular::candidate_cubes(
+    const lattice& l, int scope, 
+    const field_data_snapshot_t<T>& s0, const field_data_snapshot_t<T>& s1, 
+    std::vector<std::array<int, ND>>& corners) const
+{
+  const int nd = ND - 1; // number of spatial dimensions (and components)
+  for (int i = 0; i < ND; i ++) 
+    if (l.size(i) == 0) return;
+
+  const int t = l.start(nd);
+  const int nt = scope == ELEMENT_SCOPE_ORDINAL ? 1 : 2;
+  const field_data_snapshot_t<T> *s[2] = {
+    t == current_timestep ? &s0 : &s1, 
+    t + 1 == current_timestep ? &s0 : &s1
+  };
+  const minmax_pyramid<T> &P = s[0]->vector_bounds;
+
+  // the cubes as cells of the arrays, [q0, q1), and the part [c0, c1) 
+  // that is covered by the pyramids
+  bool testable = !P.empty() && P.nd() == nd;
+  for (int dt = 1; dt < nt; dt ++) {
+    const minmax_pyramid<T> &P1 = s[dt]->vector_bounds;
+    if (P1.empty() || P1.nd() != nd) testable = false;
+    else for (int i = 0; i < nd; i ++)
+      if (P1.ncells(i) != P.ncells(i)) testable = false;
+  }
+
+  std::array<long, ND-1> q0, q1, c0, c1;
+  bool covered = true;
+  for (int i = 0; i < nd; i ++) {
+    q0[i] = static_cast<long>(l.start(i)) - static_cast<long>(local_array_domain.start(i));
+    q1[i] = q0[i] + l.size(i);
+    c0[i] = testable ? std::max(q0[i], 0L) : 0;
+    c1[i] = testable ? std::min(q1[i], static_cast<long>(P.ncells(i))) : 0;
+    if (c0[i] >= c1[i]) c0[i] = c1[i] = 0;
+    if (c0[i] != q0[i] || c1[i] != q1[i]) covered = false;
+  }
+
+  std::array<int, ND> corner;
+  corner[nd] = t;
+
+  if (!covered) { // cubes out of the arrays cannot be rejected
+    std::array<long, ND-1> x = q0;
+    while (1) {
+      bool inside = true;
+      for (int i = 0; i < nd; i ++)
+        if (x[i] < c0[i] || x[i] >= c1[i]) inside = false;
+      if (!inside) {
+        for (int i = 0; i < nd; i ++)
+          corner[i] = x[i] + local_array_domain.start(i);
+        corners.push_back(corner);
+      }
+
+      int i = 0;
+      for (; i < nd; i ++) {
+        if (++ x[i] < q1[i]) break;
+        else x[i] = q0[i];
+      }
+      if (i == nd) break;
+    }
+  }
+  for (int i = 0; i < nd; i ++)
+    if (c0[i] >= c1[i]) return;
+
+  // offsets of the 2^nd vertices of a cube in the arrays
+  const ndarray<T> &V = s[0]->vector;
+  std::array<size_t, ND-1> stride;
+  std::vector<size_t> offsets;
+  size_t sv = V.dim(0);
+  for (int i = 0; i < nd; i ++) {
+    stride[i] = sv;
+    sv *= V.dim(i+1);
+  }
+  for (int k = 0; k < (1 << nd); k ++) {
+    size_t o = 0;
+    for (int i = 0; i < nd; i ++)
+      if (k & (1 << i)) o += stride[i];
+    offsets.push_back(o);
+  }
+
+  // per-cube test within a brick: bit j of the code is set if the j-th 
+  // component is positive at all vertices, and bit j+4 if negative
+  auto check_cube = [&](const std::array<long, ND-1>& x) {
+    size_t base = 0;
+    for (int i = 0; i < nd; i ++)
+      base += x[i] * stride[i];
+
+    uint8_t code = 0xff;
+    for (int dt = 0; dt < nt; dt ++) {
+      const T *p = s[dt]->vector.data() + base;
+      for (const auto o : offsets) {
+        uint8_t c = 0;
+        for (int j = 0; j < nd; j ++)
+          c |= ((p[o+j] > 0) << j) | ((p[o+j] < 0) << (j+4));
+        code &= c;
+      }
+    }
+    if (code == 0) {
+      for (int i = 0; i < nd; i ++)
+        corner[i] = x[i] + local_array_domain.start(i);
+      corners.push_back(corner);
+    }
+  };
+
+  // a block is rejected if a component has a strict sign over the block in 
+  // all timesteps
+  auto check_block = [&](int k, const std::array<size_t, ND-1>& b) {
+    const size_t idx = P.block_index(k, b.data());
+    for (int j = 0; j < nd; j ++) {
+      T lo = std::numeric_limits<T>::infinity(), hi = -lo;
+      for (int dt = 0; dt < nt; dt ++) {
+        lo = std::min(lo, s[dt]->vector_bounds.lower(k, idx)[j]);
+        hi = std::max(hi, s[dt]->vector_bounds.upper(k, idx)[j]);
+      }
+      if (lo > 0 || hi < 0) return false;
+    }
+    return true;
+  };
+
+  // descend from the top level, skipping blocks out of [c0, c1)
+  std::vector<std::pair<int, std::array<size_t, ND-1>>> stack;
+  const int top = P.nlevels() - 1;
+  std::array<size_t, ND-1> b;
+  for (int i = 0; i < nd; i ++) b[i] = 0;
+  while (1) {
+    stack.push_back(std::make_pair(top, b));
+    int i = 0;
+    for (; i < nd; i ++) {
+      if (++ b[i] < P.nblocks(top, i)) break;
+      else b[i] = 0;
+    }
+    if (i == nd) break;
+  }
+
+  while (!stack.empty()) {
+    const int k = stack.back().first;
+    const std::array<size_t, ND-1> b = stack.back().second;
+    stack.pop_back();
+
+    std::array<long, ND-1> x0, x1; // cells of the block in [c0, c1)
+    bool empty = false;
+    for (int i = 0; i < nd; i ++) {
+      x0[i] = std::max(static_cast<long>(b[i] * P.block_size(k)), c0[i]);
+      x1[i] = std::min(static_cast<long>((b[i] + 1) * P.block_size(k)), c1[i]);
+      if (x0[i] >= x1[i]) empty = true;
+    }
+    if (empty || !check_block(k, b)) continue;
+
+    if (k == 0) {
+      std::array<long, ND-1> x = x0;
+      while (1) {
+        check_cube(x);
+        int i = 0;
+        for (; i < nd; i ++) {
+          if (++ x[i] < x1[i]) break;
+          else x[i] = x0[i];
+        }
+        if (i == nd) break;
+      }
+    } else {
+      for (int m = 0; m < (1 << nd); m ++) {
+        std::array<size_t, ND-1> child;
+        bool valid = true;
+        for (int i = 0; i < nd; i ++) {
+          child[i] = b[i] * 2 + ((m >> i) & 1);
+          if (child[i] >= P.nblocks(k-1, i)) valid = false;
+        }
+        if (valid) stack.push_back(std::make_pair(k-1, child));
+      }
+    }
+  }
+}
+
+template <int ND, typename CP>
+inline void critical_point_tracker_regular::redistribute_connected_components(
+    const regular_simplex_mesh& m, int d, 
+    std::unordered_map<uint64_t, CP>& discrete_critical_points)
+{
+  typedef regular_simplex_mesh_fixed_element<ND> fixed_element_t;
+  const int np = comm.size();
+
+  // cores of all procs; a simplex is owned by the proc whose core contains 
+  // the spatial part of its corner, and with time windows, by the procs of 
+  // the windows next to its time, as the 3D trackers label the intervals 
+  // one timestep behind
+  const auto cores = gather_local_domains();
+
+  std::vector<uint64_t> local_ids;
+  for (const auto &kv : discrete_critical_points)
+    local_ids.push_back(kv.first);
+  std::sort(local_ids.begin(), local_ids.end());
+
+  // send ids of critical points to the procs that own their neighbors
+  std::vector<std::vector<uint64_t>> ghost_ids(np);
+  for (const auto id : local_ids) {
+    fixed_element_t e(d);
+    e.from_integer(m, id);
+    e.for_each_side_of(m, [&](const fixed_element_t& c) {
+      c.for_each_side(m, [&](const fixed_element_t& e1) {
+        if (!e1.valid(m)) return;
+        for (int p = 0; p < np; p ++)
+          if (p != comm.rank() && core_contains(cores[p], e1.corner.data(), 1) 
+              && (ghost_ids[p].empty() || ghost_ids[p].back() != id))
+            ghost_ids[p].push_back(id);
+      });
+    });
+  }
+  diy::mpi::redistribute(comm, ghost_ids, ghost_ids);
+
+  // local and ghost critical points in ascending order
+  std::vector<uint64_t> ids(local_ids);
+  for (int p = 0; p < np; p ++)
+    for (const auto id : ghost_ids[p])
+      ids.push_back(id);
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  Block_Union_Find_T<uint64_t> b;
+  for (const auto id : local_ids) {
+    b.add(id);
+    b.set_gid(id, comm.rank());
+  }
+  for (int p = 0; p < np; p ++)
+    for (const auto id : ghost_ids[p])
+      b.set_gid(id, p);
+
+  // every union is added once, by the owner of the larger id
+  const auto graph = m.element_adjacency<ND>(d, ids);
+  for (size_t i = 0; i < ids.size(); i ++) {
+    if (!b.has(ids[i])) continue; // ghost
+    for (auto j = graph.neighbors_begin(i); j != graph.neighbors_end(i); j ++)
+      if (ids[*j] < ids[i])
+        b.add_related_element(ids[i], ids[*j]);
+  }
+
+  diy::Master master(comm, 1);
+  diy::ContiguousAssigner assigner(np, np);
+  std::vector<Block_Union_Find_T<uint64_t>*> blocks(1, &b);
+  exec_distributed_union_find(comm, master, assigner, blocks);
+
+  // move every critical point to the proc determined by its root
+  std::vector<std::vector<std::pair<uint64_t, CP>>> outgoing(np);
+  for (const auto id : local_ids)
+    outgoing[hash_id(b.parent(id), np)].push_back(std::make_pair(id, discrete_critical_points[id]));
+  diy::mpi::redistribute(comm, outgoing, outgoing);
+
+  discrete_critical_points.clear();
+  for (const auto &cps : outgoing)
+    discrete_critical_points.insert(cps.begin(), cps.end());
+}
+
 }
 
 #endif
@@ -5,6 +5,11 @@
 #include <ftk/external/diy/mpi.hpp>
 #include <ftk/external/cxxopts.hpp>
 #include <mutex>
+#include <thread>
+#include <algorithm>
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 namespace ftk {
 
@@ -18,9 +23,7 @@ enum {
 };
 
 struct filter {
-  filter() {
-    nthreads = default_nthreads();
-  }
+  filter() {}
 
   filter(int argc, char **argv) {
     parse_arguments(argc, argv);
@@ -30,14 +33,15 @@ struct filter {
   virtual void reset() {};
 
   void use_accelerator(int i) {xl = i;}
+  void set_number_of_threads(int n) {nthreads = n;}
 
   void parse_arguments(int argc, char **argv) {
     std::string str_xl;
 
     cxxopts::Options options(argv[0]);
     options.add_options()
-      ("nthreads", "number of threads", 
-        cxxopts::value<int>(nthreads)->default_value(std::to_string(default_nthreads())))
+      ("nthreads", "number of threads (0 for the default)", 
+        cxxopts::value<int>(nthreads)->default_value("0"))
       ("x,accelerator", "use accelerator: none|cuda|kokkos|openmp|sycl|tbb", 
         cxxopts::value<std::string>(str_xl)->default_value("none"));
     auto results = options.parse(argc, argv);
@@ -51,19 +55,63 @@ struct filter {
     }
   }
 
-  int default_nthreads() const {
-    if (comm.size() > 1) return 1; // use 1 thread per proc for mpi runs
-    else return std::thread::hardware_concurrency(); 
-  }
+  // With multiple procs, the cores of a node are divided among its procs, 
+  // and a proc that is bound to fewer cores (e.g. to a NUMA domain with 
+  // `mpirun --map-by numa --bind-to numa') uses no more than those, so that 
+  // its threads stay in the domain where its snapshots are first touched.  
+  // Only the main thread calls MPI, which needs MPI_THREAD_FUNNELED; with 
+  // a lower level of thread support, one thread is used.  Collective over 
+  // the procs of the filter.
+  int default_nthreads() const;
 
 protected:
+  // Collective; sets the default number of threads unless it has been set.  
+  // Filters call this in initialize(), so that constructing them needs no 
+  // communication.
+  void initialize_number_of_threads();
+
   diy::mpi::communicator comm;
 
   int xl = FTK_XL_NONE;
-  int nthreads = 1;
+  int nthreads = 0; // 0 for the default
   std::mutex mutex;
 };
 
+/////
+inline void filter::initialize_number_of_threads()
+{
+  // every proc takes part, even if its number of threads has been set
+  const int n = default_nthreads();
+  if (nthreads <= 0) nthreads = n;
+}
+
+inline int filter::default_nthreads() const
+{
+  if (comm.size() <= 1) return std::thread::hardware_concurrency();
+#ifndef DIY_NO_MPI
+  int level = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&level);
+  if (level < MPI_THREAD_FUNNELED) return 1;
+
+  // procs on the same node
+  MPI_Comm node;
+  int nlocal = 1;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, comm.rank(), MPI_INFO_NULL, &node);
+  MPI_Comm_size(node, &nlocal);
+  MPI_Comm_free(&node);
+
+  int ncores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / nlocal);
+#if defined(__linux__)
+  cpu_set_t mask;
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+    ncores = std::min(ncores, CPU_COUNT(&mask));
+#endif
+  return std::max(1, ncores);
+#else
+  return 1;
+#endif
+}
+
 }
 
 #endif
@@ -2,8 +2,10 @@
 #define _FTK_CC2CURVE_HH
 
 #include <ftk/algorithms/cca.hh>
+#include <ftk/basic/csr_graph.hh>
 #include <list>
 #include <set>
+#include <array>
 
 namespace ftk {
 
@@ -97,6 +99,80 @@ std::vector<std::vector<NodeType>> connected_component_to_linear_components(
   return linear_components;
 }
 
+// Integer version of the above; the connected component is given as an 
+// ascending list of node indices in the graph g
+template <typename IndexType>
+std::vector<std::vector<IndexType>> connected_component_to_linear_components(
+    const std::vector<IndexType>& connected_component,
+    const csr_graph<IndexType>& g)
+{
+  std::vector<std::vector<IndexType>> linear_components;
+  const size_t n = connected_component.size();
+  
+  auto local_index = [&](IndexType i) { // returns n if i is not in the component
+    auto it = std::lower_bound(connected_component.begin(), connected_component.end(), i);
+    if (it != connected_component.end() && *it == i) return static_cast<size_t>(it - connected_component.begin());
+    else return n;
+  };
+
+  // nodes with more than two neighbors in the component are special; 
+  // ordinary nodes keep (at most two) ordinary neighbors
+  std::vector<bool> special(n, false);
+  for (size_t i = 0; i < n; i ++) {
+    const IndexType node = connected_component[i];
+    size_t deg = 0;
+    for (auto p = g.neighbors_begin(node); p != g.neighbors_end(node); p ++)
+      if (*p != node && local_index(*p) != n) deg ++;
+    special[i] = deg > 2;
+  }
+
+  const size_t none = n;
+  std::vector<std::array<size_t, 2>> ordinary_neighbors(n, {none, none});
+  for (size_t i = 0; i < n; i ++) {
+    if (special[i]) continue;
+    const IndexType node = connected_component[i];
+    int k = 0;
+    for (auto p = g.neighbors_begin(node); p != g.neighbors_end(node); p ++) {
+      const size_t j = local_index(*p);
+      if (*p != node && j != n && !special[j])
+        ordinary_neighbors[i][k ++] = j;
+    }
+  }
+
+  // trace linear graphs of ordinary nodes from the smallest unvisited seeds
+  std::vector<bool> visited(n, false);
+  for (size_t seed = 0; seed < n; seed ++) {
+    if (special[seed] || visited[seed]) continue;
+    visited[seed] = true;
+
+    std::list<IndexType> trace; // isolated nodes make single-node linear graphs
+    trace.push_back(connected_component[seed]);
+
+    for (int dir = 0; dir < 2; dir ++) {
+      size_t current = ordinary_neighbors[seed][dir];
+      while (current != none && !visited[current]) {
+        if (dir == 0) trace.push_back(connected_component[current]);
+        else trace.push_front(connected_component[current]);
+        visited[current] = true;
+
+        size_t next = none;
+        for (int k = 0; k < 2; k ++) {
+          const size_t j = ordinary_neighbors[current][k];
+          if (j != none && !visited[j]) {
+            next = j;
+            break;
+          }
+        }
+        current = next;
+      }
+    }
+
+    linear_components.push_back(std::vector<IndexType>({trace.begin(), trace.end()}));
+  }
+
+  return linear_components;
+}
+
 }
 
 #endif
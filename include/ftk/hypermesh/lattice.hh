@@ -40,6 +40,10 @@ struct lattice {
   template <typename uint=uint64_t> uint to_integer(const std::vector<int> &coords) const;
   template <typename uint=uint64_t> std::vector<int> from_integer(uint i) const;
 
+  // allocation-free versions of to_integer/from_integer; coords has nd() elements
+  template <typename uint=uint64_t> uint to_integer(const int coords[]) const;
+  template <typename uint=uint64_t> void from_integer(uint i, int coords[]) const;
+
   // size_t global_index(const std::vector<size_t> &coords) const;
   size_t local_index(int p, const std::vector<size_t> &coords) const;
 
@@ -170,6 +174,28 @@ inline std::vector<int> lattice::from_integer(uint i) const
   return idx;
 }
 
+template <typename uint> 
+inline uint lattice::to_integer(const int idx[]) const
+{
+  uint i(idx[0] - starts_[0]);
+  for (auto j = 1; j < nd(); j ++)
+    i += (idx[j] - starts_[j]) * prod_[j];
+  return i;
+}
+
+template <typename uint>
+inline void lattice::from_integer(uint i, int idx[]) const
+{
+  for (auto j = nd()-1; j > 0; j --) {
+    idx[j] = i / prod_[j];
+    i -= idx[j] * prod_[j];
+  }
+  idx[0] = i;
+
+  for (auto j = 0; j < nd(); j ++)
+    idx[j] += starts_[j];
+}
+
 }
 
 #endif
@@ -2,6 +2,9 @@
 #define _FTK_LATTICE_PARTITIONER_HH
 
 #include <ftk/hypermesh/lattice.hh>
+#include <numeric>
+#include <limits>
+#include <algorithm>
 
 namespace ftk {
 
@@ -25,6 +28,20 @@ public: // partitioning
       const std::vector<size_t> &ghost_low, 
       const std::vector<size_t> &ghost_high); // regular partition w/ given number of cuts and ghost sizes per dimension
 
+  // Recursive bisection into np blocks of about equal cost.  The cuttable 
+  // dimensions of the lattice are divided into bins of bin_size vertices 
+  // (the last bins may be smaller), and cost has one positive element per 
+  // bin, the first dimension being the fastest, e.g. the work measured in 
+  // previous timesteps.  Every block is cut on bin boundaries along its 
+  // longest dimension, so that the cost on both sides is in proportion to 
+  // the numbers of ranks.
+  void partition_weighted(size_t np, 
+      const std::vector<double> &cost, size_t bin_size,
+      const std::vector<size_t> &ghost_low, 
+      const std::vector<size_t> &ghost_high);
+
+  size_t nbins(size_t d, size_t bin_size) const {return (l.size(d) + bin_size - 1) / bin_size;}
+
   const lattice& get_core(size_t i) const {return cores[i];}
   const lattice& get_ext(size_t i) const {return extents[i];}
 
@@ -32,6 +49,8 @@ public: // partitioning
 
 private:
   void partition(std::vector<std::vector<size_t>> prime_factors_dims);
+  bool bisect(size_t np, const std::vector<size_t>& b0, const std::vector<size_t>& b1, // bins [b0, b1)
+      const std::vector<double> &cost, size_t bin_size);
 
   template<typename uint = size_t>
   static std::vector<uint> prime_factorization(uint n);
@@ -160,36 +179,139 @@ inline void lattice_partitioner::partition(size_t np,
   if (cores.size() == 0) return;
 
   // apply ghosts
-  for(const auto& core : cores) {
-    auto starts = core.starts(), 
-         sizes = core.sizes();
-
-    for(int d = 0; d < ndim; ++d) {
-      // ghost_low layer
-      {
-        size_t offset = starts[d] - l.start(d); 
-        if(ghost_low[d] < offset) {
-          offset = ghost_low[d]; 
-        }
+  for(const auto& core : cores)
+    extents.push_back(add_ghost(core, ghost_low, ghost_high));
+}
 
-        starts[d] -= offset; 
-        sizes[d] += offset;
+inline lattice lattice_partitioner::add_ghost(const lattice& core, 
+    const std::vector<size_t> &ghost_low, 
+    const std::vector<size_t> &ghost_high) const
+{
+  auto starts = core.starts(), 
+       sizes = core.sizes();
+
+  for(int d = 0; d < l.nd_cuttable(); ++d) {
+    // ghost_low layer
+    if (d < ghost_low.size()) {
+      size_t offset = starts[d] - l.start(d); 
+      if(ghost_low[d] < offset) {
+        offset = ghost_low[d]; 
       }
 
-      // ghost_high layer
-      {
-        size_t offset = (l.start(d) + l.size(d)) - (starts[d] + sizes[d]); 
-        if(ghost_high[d] < offset) {
-          offset = ghost_high[d]; 
-        }
+      starts[d] -= offset; 
+      sizes[d] += offset;
+    }
 
-        sizes[d] += offset;
+    // ghost_high layer
+    if (d < ghost_high.size()) {
+      size_t offset = (l.start(d) + l.size(d)) - (starts[d] + sizes[d]); 
+      if(ghost_high[d] < offset) {
+        offset = ghost_high[d]; 
       }
+
+      sizes[d] += offset;
     }
+  }
 
-    lattice ext(starts, sizes);
-    extents.push_back(ext);
+  return lattice(starts, sizes);
+}
+
+inline void lattice_partitioner::partition_weighted(size_t np, 
+    const std::vector<double> &cost, size_t bin_size,
+    const std::vector<size_t> &ghost_low, 
+    const std::vector<size_t> &ghost_high)
+{
+  cores.clear();
+  extents.clear();
+  if (np <= 0) return;
+
+  const int ndim = l.nd_cuttable();
+  std::vector<size_t> b0(ndim, 0), b1(ndim);
+  size_t n = 1;
+  for (int d = 0; d < ndim; d ++) {
+    b1[d] = nbins(d, bin_size);
+    n *= b1[d];
   }
+  if (cost.size() != n || !bisect(np, b0, b1, cost, bin_size)) {
+    cores.clear();
+    return;
+  }
+
+  for(const auto& core : cores)
+    extents.push_back(add_ghost(core, ghost_low, ghost_high));
+}
+
+inline bool lattice_partitioner::bisect(size_t np, 
+    const std::vector<size_t>& b0, const std::vector<size_t>& b1, 
+    const std::vector<double> &cost, size_t bin_size)
+{
+  const int ndim = b0.size();
+  size_t nb = 1; // number of bins in the block
+  for (int d = 0; d < ndim; d ++)
+    nb *= b1[d] - b0[d];
+  if (nb < np) return false;
+
+  if (np == 1) {
+    std::vector<size_t> starts(l.starts()), sizes(l.sizes());
+    for (int d = 0; d < ndim; d ++) {
+      starts[d] = l.start(d) + b0[d] * bin_size;
+      sizes[d] = std::min(l.start(d) + b1[d] * bin_size, l.start(d) + l.size(d)) - starts[d];
+    }
+    cores.push_back(lattice(starts, sizes));
+    return true;
+  }
+
+  // the longest dimension of the block in vertices
+  int dc = 0;
+  size_t longest = 0;
+  for (int d = 0; d < ndim; d ++) {
+    const size_t len = std::min(b1[d] * bin_size, l.size(d)) - b0[d] * bin_size;
+    if (b1[d] - b0[d] > 1 && len > longest) {
+      dc = d;
+      longest = len;
+    }
+  }
+
+  // cost of the slabs of bins along dc
+  std::vector<double> slabs(b1[dc] - b0[dc], 0.0);
+  std::vector<size_t> b(b0);
+  while (1) {
+    size_t i = 0, stride = 1;
+    for (int d = 0; d < ndim; d ++) {
+      i += b[d] * stride;
+      stride *= nbins(d, bin_size);
+    }
+    slabs[b[dc] - b0[dc]] += cost[i];
+
+    int d = 0;
+    for (; d < ndim; d ++) {
+      if (++ b[d] < b1[d]) break;
+      else b[d] = b0[d];
+    }
+    if (d == ndim) break;
+  }
+
+  // the cut that is closest to the share of the first half of the ranks, 
+  // leaving at least one bin per rank on both sides
+  const size_t np0 = np / 2, np1 = np - np0, 
+               nslab = nb / (b1[dc] - b0[dc]); // bins per slab
+  const double total = std::accumulate(slabs.begin(), slabs.end(), 0.0), 
+               target = total * np0 / np;
+  size_t cut = 0;
+  double prefix = 0, best = std::numeric_limits<double>::max();
+  for (size_t k = 1; k < slabs.size(); k ++) {
+    prefix += slabs[k-1];
+    if (k * nslab < np0 || (slabs.size() - k) * nslab < np1) continue;
+    if (std::abs(prefix - target) < best) {
+      best = std::abs(prefix - target);
+      cut = k;
+    }
+  }
+  if (cut == 0) return false;
+
+  std::vector<size_t> c1(b1), c0(b0);
+  c1[dc] = c0[dc] = b0[dc] + cut;
+  return bisect(np0, b0, c1, cost, bin_size) && bisect(np1, c0, b1, cost, bin_size);
 }
 
 
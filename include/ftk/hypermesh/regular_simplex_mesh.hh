@@ -5,6 +5,7 @@
 #include <iostream>
 #include <sstream> 
 #include <vector>
+#include <array>
 #include <tuple>
 #include <set>
 #include <string>
@@ -12,9 +13,14 @@
 #include <numeric>
 #include <thread>
 #include <cassert>
+#include <cmath>
+#include <memory>
 #include <iterator>
 #include <functional>
 #include <ftk/hypermesh/lattice.hh>
+#include <ftk/hypermesh/regular_simplex_mesh_tables.hh>
+#include <ftk/utils/thread_pool.hh>
+#include <ftk/basic/csr_graph.hh>
 #include <ftk/external/diy/serialization.hpp>
 
 #if FTK_HAVE_KOKKOS
@@ -27,12 +33,6 @@
 
 namespace ftk {
 
-enum {
-  ELEMENT_SCOPE_ALL = 0,
-  ELEMENT_SCOPE_ORDINAL = 1, 
-  ELEMENT_SCOPE_INTERVAL = 2
-};
-
 struct regular_simplex_mesh;
 
 struct regular_simplex_mesh_element {
@@ -82,9 +82,47 @@ struct regular_simplex_mesh_element {
   int dim, type;
 };
 
+// Fixed-dimensional counterpart of regular_simplex_mesh_element.  The corner 
+// is stored in a std::array, so that elements can be created, copied, and 
+// visited without heap allocations; unit simplices are looked up from 
+// unit_simplex_table<ND>.
+template <int ND>
+struct regular_simplex_mesh_fixed_element {
+  typedef unit_simplex_table<ND> table;
+
+  regular_simplex_mesh_fixed_element() : dim(0), type(0) {corner.fill(0);}
+  explicit regular_simplex_mesh_fixed_element(int d) : dim(d), type(0) {corner.fill(0);}
+  explicit regular_simplex_mesh_fixed_element(const regular_simplex_mesh_element& e);
+
+  bool operator!=(const regular_simplex_mesh_fixed_element& e) const {return !(*this == e);}
+  bool operator<(const regular_simplex_mesh_fixed_element& e) const;
+  bool operator==(const regular_simplex_mesh_fixed_element& e) const;
+
+  regular_simplex_mesh_element to_element() const;
+
+  // writes dim+1 vertices to v
+  void vertices(const regular_simplex_mesh&, int v[][ND]) const;
+
+  bool valid(const regular_simplex_mesh& m) const;
+
+  // call f(e) for every (dim-1)-dimensional side, or for every 
+  // (dim+1)-dimensional element that the simplex is a side of
+  template <typename F> void for_each_side(const regular_simplex_mesh& m, F&& f) const;
+  template <typename F> void for_each_side_of(const regular_simplex_mesh& m, F&& f) const;
+
+  void from_work_index(const regular_simplex_mesh& m, size_t, const lattice& l, int scope = ELEMENT_SCOPE_ALL);
+
+  template <typename uint = uint64_t> uint to_integer(const regular_simplex_mesh& m) const;
+  template <typename uint = uint64_t> void from_integer(const regular_simplex_mesh& m, uint i);
+
+  std::array<int, ND> corner;
+  int dim, type;
+};
+
 
 struct regular_simplex_mesh {
   friend class regular_simplex_mesh_element;
+  template <int> friend struct regular_simplex_mesh_fixed_element;
   typedef regular_simplex_mesh_element iterator;
 
   regular_simplex_mesh(int n) : nd_(n), lattice_(n) {
@@ -162,6 +200,38 @@ struct regular_simplex_mesh {
       std::function<void(regular_simplex_mesh_element)> f,
       int nthreads=std::thread::hardware_concurrency());
 
+  // Allocation-free version of element_for for ND-dimensional meshes.  Every 
+  // D-simplex in the subdomain is passed to f(e, vertices, tid) as a 
+  // regular_simplex_mesh_fixed_element<ND> along with its D+1 vertices, which 
+  // are stored on the stack as `const int vertices[D+1][ND]', and the id of 
+  // the calling thread in [0, nthread_ids(nthreads)).  The subdomain 
+  // is cut into tiles of about tile_volume() vertices; each tile is visited 
+  // by a single thread in memory order, and idle threads steal tiles.
+  template <int ND, int D, typename F>
+  void element_for(const lattice& subdomain, int scope, F&& f, 
+      int nthreads=std::thread::hardware_concurrency());
+
+  // Same as above, but only visits the D-simplices whose corners are in the 
+  // given list, e.g. cubes that survive a quick-reject test
+  template <int ND, int D, typename F>
+  void element_for(const std::vector<std::array<int, ND>>& corners, int scope, F&& f, 
+      int nthreads=std::thread::hardware_concurrency());
+
+  // Adjacency graph of the given d-simplices (ascending element ids); two 
+  // simplices are adjacent if they are sides of a common (d+1)-simplex.  
+  // Node i of the graph corresponds to ids[i].
+  template <int ND>
+  csr_graph<size_t> element_adjacency(int d, const std::vector<uint64_t>& ids) const;
+
+  // Number of vertices per tile in element_for; the default keeps the field 
+  // data touched by a tile within a typical L2 cache
+  size_t tile_volume() const {return tile_volume_;}
+  void set_tile_volume(size_t n) {tile_volume_ = std::max(n, size_t(1));}
+
+  // Upper bound of the thread ids passed to element_for callbacks, for callers 
+  // that keep per-thread states
+  int nthread_ids(int nthreads) const;
+
 #if 0
 public: // partitioning
   void partition(int np, std::vector<std::tuple<regular_simplex_mesh, regular_simplex_mesh>>& partitions);  
@@ -204,13 +274,19 @@ private: // initialization functions
 
   void derive_ordinal_and_interval_simplices();
 
+  // Run f(j, tid) for j in [0, ntasks) with the given number of threads
+  template <typename F> void parallel_for(size_t ntasks, const F& f, int nthreads, size_t grain) const;
+
+  // The pool is created on demand and recreated if nthreads changes
+  thread_pool& get_thread_pool(int nthreads) const;
+
   // bool is_simplex_identical(const std::vector<std::string>&, const std::vector<std::string>&) const;
 
 private:
   const int nd_;
   std::vector<int> lb_, ub_; // lower and upper bounds of each dimension
   std::vector<int> ntypes_, ntypes_ordinal_, ntypes_interval_; // number of types for k-simplex
-  std::vector<int> dimprod_;
+  std::vector<uint64_t> dimprod_;
 
   struct lattice lattice_; 
 
@@ -226,6 +302,9 @@ private:
   // (dim,type) --> vector of (type,offset)
   std::vector<std::vector<std::vector<std::tuple<int, std::vector<int>>>>> unit_simplex_sides;
   std::vector<std::vector<std::vector<std::tuple<int, std::vector<int>>>>> unit_simplex_side_of;
+
+  size_t tile_volume_ = 4096;
+  mutable std::shared_ptr<thread_pool> pool_;
 };
 
 
@@ -422,7 +501,7 @@ uint regular_simplex_mesh_element::to_integer(const regular_simplex_mesh& m) con
 {
   uint corner_index = 0;
   for (size_t i = 0; i < m.nd(); i ++)
-    corner_index += (corner[i] - m.lb(i)) * m.dimprod_[i];
+    corner_index += static_cast<uint>(corner[i] - m.lb(i)) * m.dimprod_[i];
   return corner_index * m.ntypes(dim) + type;
 }
 
@@ -525,6 +604,120 @@ inline std::vector<regular_simplex_mesh_element> regular_simplex_mesh_element::s
   return side_of;
 }
 
+template <int ND>
+regular_simplex_mesh_fixed_element<ND>::regular_simplex_mesh_fixed_element(const regular_simplex_mesh_element& e)
+  : dim(e.dim), type(e.type)
+{
+  std::copy_n(e.corner.begin(), ND, corner.begin());
+}
+
+template <int ND>
+bool regular_simplex_mesh_fixed_element<ND>::operator<(const regular_simplex_mesh_fixed_element& e) const
+{
+  if (corner < e.corner) return true;
+  else if (corner == e.corner) return type < e.type;
+  else return false;
+}
+
+template <int ND>
+bool regular_simplex_mesh_fixed_element<ND>::operator==(const regular_simplex_mesh_fixed_element& e) const
+{
+  return dim == e.dim && type == e.type && corner == e.corner;
+}
+
+template <int ND>
+regular_simplex_mesh_element regular_simplex_mesh_fixed_element<ND>::to_element() const
+{
+  return regular_simplex_mesh_element(std::vector<int>(corner.begin(), corner.end()), dim, type);
+}
+
+template <int ND>
+void regular_simplex_mesh_fixed_element<ND>::vertices(const regular_simplex_mesh& m, int v[][ND]) const
+{
+  const int *offsets = table::offsets(dim, type);
+  for (int i = 0; i <= dim; i ++)
+    for (int j = 0; j < ND; j ++)
+      v[i][j] = corner[j] + offsets[i*ND + j];
+}
+
+template <int ND>
+bool regular_simplex_mesh_fixed_element<ND>::valid(const regular_simplex_mesh& m) const
+{
+  if (type < 0 || type >= table::ntypes(dim)) return false;
+  
+  const int *offsets = table::offsets(dim, type);
+  for (int i = 0; i <= dim; i ++)
+    for (int j = 0; j < ND; j ++) {
+      const int x = corner[j] + offsets[i*ND + j];
+      if (x < m.lb(j) || x > m.ub(j))
+        return false;
+    }
+  return true;
+}
+
+template <int ND>
+template <typename F>
+void regular_simplex_mesh_fixed_element<ND>::for_each_side(const regular_simplex_mesh& m, F&& f) const
+{
+  regular_simplex_mesh_fixed_element<ND> side(dim-1);
+  const int n = table::nsides(dim), *s = table::sides(dim, type);
+  for (int j = 0; j < n; j ++, s += ND+1) {
+    side.type = s[0];
+    for (int i = 0; i < ND; i ++)
+      side.corner[i] = corner[i] + s[i+1];
+    f(side);
+  }
+}
+
+template <int ND>
+template <typename F>
+void regular_simplex_mesh_fixed_element<ND>::for_each_side_of(const regular_simplex_mesh& m, F&& f) const
+{
+  regular_simplex_mesh_fixed_element<ND> e(dim+1);
+  const int n = table::nside_of(dim, type), *s = table::side_of(dim, type);
+  for (int j = 0; j < n; j ++, s += ND+1) {
+    e.type = s[0];
+    for (int i = 0; i < ND; i ++)
+      e.corner[i] = corner[i] + s[i+1];
+    f(e);
+  }
+}
+
+template <int ND>
+void regular_simplex_mesh_fixed_element<ND>::from_work_index(const regular_simplex_mesh& m, size_t i, const lattice& l, int scope)
+{
+  const auto itype = i % table::ntypes(dim, scope);
+  const auto ii = i / table::ntypes(dim, scope);
+ 
+  type = table::scoped_type(dim, scope, itype);
+  l.from_integer(ii, corner.data());
+}
+
+template <int ND>
+template <typename uint>
+uint regular_simplex_mesh_fixed_element<ND>::to_integer(const regular_simplex_mesh& m) const
+{
+  uint corner_index = 0;
+  for (size_t i = 0; i < ND; i ++)
+    corner_index += static_cast<uint>(corner[i] - m.lb(i)) * m.dimprod_[i];
+  return corner_index * table::ntypes(dim) + type;
+}
+
+template <int ND>
+template <typename uint>
+void regular_simplex_mesh_fixed_element<ND>::from_integer(const regular_simplex_mesh& m, uint index)
+{
+  type = index % table::ntypes(dim);
+  uint corner_index = index / table::ntypes(dim);
+
+  for (int i = ND - 1; i >= 0; i --) {
+    corner[i] = corner_index / m.dimprod_[i]; 
+    corner_index -= corner[i] * m.dimprod_[i];
+  }
+  for (int i = 0; i < ND; i ++) 
+    corner[i] += m.lb(i);
+}
+
 inline int regular_simplex_mesh::ntypes(int d, int scope) const 
 {
   switch (scope) {
@@ -830,7 +1023,7 @@ inline void regular_simplex_mesh::set_lb_ub(const std::vector<int>& l, const std
 
   for (int i = 0; i < nd()+1; i ++) {
     if (i == 0) dimprod_[i] = 1;
-    else dimprod_[i] = (u[i-1] - l[i-1] + 1) * dimprod_[i-1];
+    else dimprod_[i] = (static_cast<uint64_t>(u[i-1] - l[i-1]) + 1) * dimprod_[i-1];
   }
 }
 
@@ -909,37 +1102,166 @@ inline void regular_simplex_mesh::element_for(
     std::function<void(regular_simplex_mesh_element)> f,
     int nthreads)
 {
-  auto lambda = [=](size_t j) {
+  auto lambda = [&](size_t j, int) {
     regular_simplex_mesh_element e(*this, d, j, l, scope);
     f(e);
   };
 
-  const auto ntasks = l.n() * ntypes(d, scope);
+  parallel_for(l.n() * ntypes(d, scope), lambda, nthreads, 256);
+}
+
+template <int ND, int D, typename F>
+void regular_simplex_mesh::element_for(
+    const lattice& l, int scope, F&& f, int nthreads)
+{
+  static_assert(D <= ND, "the simplex dimension cannot exceed the mesh dimension");
+  assert(ND == nd());
+
+  // tiles are (nearly) cubes over the dimensions that are longer than one
+  int ncut = 0;
+  for (int i = 0; i < ND; i ++)
+    if (l.size(i) > 1) ncut ++;
+  const size_t edge = ncut == 0 ? 1 : 
+    std::max(size_t(1), static_cast<size_t>(std::pow(static_cast<double>(tile_volume_), 1.0 / ncut)));
+
+  std::array<size_t, ND> tile_size, ntiles;
+  size_t ntiles_total = 1;
+  for (int i = 0; i < ND; i ++) {
+    tile_size[i] = std::min(l.size(i), edge);
+    ntiles[i] = (l.size(i) + tile_size[i] - 1) / tile_size[i];
+    ntiles_total *= ntiles[i];
+  }
+
+  typedef unit_simplex_table<ND> table;
+  const int nt = table::ntypes(D, scope);
+  auto visit_tile = [&](size_t k, int tid) {
+    std::array<int, ND> lo, hi, c;
+    for (int i = 0; i < ND; i ++) {
+      const size_t ti = k % ntiles[i];
+      k /= ntiles[i];
+      lo[i] = l.start(i) + ti * tile_size[i];
+      hi[i] = std::min(lo[i] + tile_size[i], l.start(i) + l.size(i));
+    }
+
+    regular_simplex_mesh_fixed_element<ND> e(D);
+    int vertices[D+1][ND];
+
+    c = lo;
+    while (1) {
+      e.corner = c;
+      for (int j = 0; j < nt; j ++) {
+        e.type = table::scoped_type(D, scope, j);
+        e.vertices(*this, vertices);
+        f(e, vertices, tid);
+      }
+
+      int i = 0; // advance the corner; the first dimension is the fastest
+      for (; i < ND; i ++) {
+        if (++ c[i] < hi[i]) break;
+        else c[i] = lo[i];
+      }
+      if (i == ND) break;
+    }
+  };
+
+  parallel_for(ntiles_total, visit_tile, nthreads, 1);
+}
+
+template <int ND, int D, typename F>
+void regular_simplex_mesh::element_for(
+    const std::vector<std::array<int, ND>>& corners, int scope, F&& f, int nthreads)
+{
+  static_assert(D <= ND, "the simplex dimension cannot exceed the mesh dimension");
+  assert(ND == nd());
+
+  typedef unit_simplex_table<ND> table;
+  const int nt = table::ntypes(D, scope);
+  auto visit = [&](size_t k, int tid) {
+    regular_simplex_mesh_fixed_element<ND> e(D);
+    int vertices[D+1][ND];
+
+    e.corner = corners[k];
+    for (int j = 0; j < nt; j ++) {
+      e.type = table::scoped_type(D, scope, j);
+      e.vertices(*this, vertices);
+      f(e, vertices, tid);
+    }
+  };
+
+  parallel_for(corners.size(), visit, nthreads, 64);
+}
+
+template <int ND>
+csr_graph<size_t> regular_simplex_mesh::element_adjacency(int d, const std::vector<uint64_t>& ids) const
+{
+  assert(ND == nd());
+  const size_t n = ids.size();
+  auto index = [&](uint64_t id) { // returns n if not found
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id) return static_cast<size_t>(it - ids.begin());
+    else return n;
+  };
+
+  csr_graph<size_t> g;
+  g.offsets.reserve(n + 1);
+
+  std::vector<size_t> neighbors;
+  regular_simplex_mesh_fixed_element<ND> e(d);
+  for (size_t i = 0; i < n; i ++) {
+    e.from_integer(*this, ids[i]);
+
+    neighbors.clear();
+    e.for_each_side_of(*this, [&](const regular_simplex_mesh_fixed_element<ND>& c) {
+      c.for_each_side(*this, [&](const regular_simplex_mesh_fixed_element<ND>& e1) {
+        if (!e1.valid(*this)) return; // ids are only unique for valid elements
+        const size_t j = index(e1.to_integer(*this));
+        if (j != n && j != i) 
+          neighbors.push_back(j);
+      });
+    });
+    g.add_node(neighbors);
+  }
+
+  return g;
+}
+
+inline int regular_simplex_mesh::nthread_ids(int nthreads) const
+{
+#if FTK_HAVE_KOKKOS
+  return Kokkos::DefaultHostExecutionSpace::concurrency();
+#elif FTK_HAVE_TBB
+  return tbb::this_task_arena::max_concurrency();
+#else
+  return std::max(nthreads, 1);
+#endif
+}
+
+inline thread_pool& regular_simplex_mesh::get_thread_pool(int nthreads) const
+{
+  if (!pool_ || pool_->size() != nthreads)
+    pool_.reset(new thread_pool(nthreads));
+  return *pool_;
+}
+
+template <typename F>
+void regular_simplex_mesh::parallel_for(size_t ntasks, const F& f, int nthreads, size_t grain) const
+{
   // fprintf(stderr,  "ntasks=%lu\n", ntasks);
 #if FTK_HAVE_KOKKOS
-  Kokkos::parallel_for("element_for", ntasks, KOKKOS_LAMBDA(const int& j) {f(j);});
+  Kokkos::parallel_for("element_for", 
+      Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, ntasks), 
+      [&](const size_t j) {f(j, Kokkos::DefaultHostExecutionSpace::impl_hardware_thread_id());});
 #elif FTK_HAVE_TBB
-  tbb::parallel_for(tbb::blocked_range<size_t>(0, ntasks),
-      [=](const blocked_range<size_t>& r) {
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, ntasks, grain),
+      [&](const tbb::blocked_range<size_t>& r) {
+        const int tid = tbb::this_task_arena::current_thread_index();
         for (size_t i = r.begin(); i != r.end(); ++ i) 
-          lambda(i);
+          f(i, tid);
       });
 #else
-  std::vector<std::thread> workers;
-  for (size_t i = 1; i < nthreads; i ++) {
-    workers.push_back(std::thread([=]() {
-      for (size_t j = i; j < ntasks; j += nthreads)
-        lambda(j);
-    }));
-  }
-
-  for (size_t j = 0; j < ntasks; j += nthreads) // the main thread
-    lambda(j);
-
-  std::for_each(workers.begin(), workers.end(), [](std::thread &t) {t.join();});
+  get_thread_pool(nthreads).parallel_for(ntasks, f, grain);
 #endif
 }
-
 }
 
 
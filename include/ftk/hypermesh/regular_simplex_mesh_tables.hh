@@ -0,0 +1,738 @@
+#ifndef _HYPERMESH_REGULAR_SIMPLEX_MESH_TABLES_HH
+#define _HYPERMESH_REGULAR_SIMPLEX_MESH_TABLES_HH
+
+#include <ftk/ftk_config.hh>
+
+namespace ftk {
+
+enum {
+  ELEMENT_SCOPE_ALL = 0,
+  ELEMENT_SCOPE_ORDINAL = 1, 
+  ELEMENT_SCOPE_INTERVAL = 2
+};
+
+// Subdivision of the unit ND-cube for ND <= 4, shared by host and device 
+// code.  The tables are the output of regular_simplex_mesh's runtime 
+// enumeration with identical type numbers (checked by 
+// tests/test_regular_simplex_mesh_tables.cpp), stored as flat constant 
+// arrays, so that vertices and neighbors of fixed-dimensional elements are 
+// looked up without heap allocations or nested containers.
+//
+// - ntypes(d, scope): number of d-simplex types in the given scope
+// - scoped_type(d, scope, i): type of the i-th d-simplex in the given scope
+// - offsets(d, type): (d+1)*ND vertex offsets of the unit simplex
+// - sides(d, type): nsides(d) entries of {type, offset[ND]} for the 
+//   (d-1)-simplices that bound the simplex
+// - side_of(d, type): nside_of(d, type) entries of {type, offset[ND]} for 
+//   the (d+1)-simplices that the simplex bounds
+template <int ND> struct unit_simplex_table;
+
+template <>
+struct unit_simplex_table<1> {
+  __device__ __host__
+  static int ntypes(int d, int scope = ELEMENT_SCOPE_ALL) {
+    static const int n[] = {1, 1, 1, 0, 0, 1};
+    return n[scope * 2 + d];
+  }
+
+  __device__ __host__
+  static int scoped_type(int d, int scope, int i) {
+    static const int types[] = {0, 0};
+    static const int begin[] = {0, 1, 1, 1};
+    return scope == ELEMENT_SCOPE_ALL ? i : types[begin[(scope - 1) * 2 + d] + i];
+  }
+
+  __device__ __host__
+  static const int* offsets(int d, int type) {
+    static const int o[] = {
+      0, 0, 1
+    };
+    static const int begin[] = {0, 1};
+    return o + begin[d] + type * (d + 1) * 1;
+  }
+
+  __device__ __host__
+  static int nsides(int d) {return d > 0 ? d + 1 : 0;}
+
+  __device__ __host__
+  static const int* sides(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, 1
+    };
+    static const int begin[] = {0, 0};
+    return s + begin[d] + type * (d + 1) * 2;
+  }
+
+  __device__ __host__
+  static int nside_of(int d, int type) {return side_of_begin(d, type + 1) - side_of_begin(d, type);}
+
+  __device__ __host__
+  static const int* side_of(int d, int type) {
+    static const int s[] = {
+      0, -1, 0, 0
+    };
+    return s + side_of_begin(d, type) * 2;
+  }
+
+private:
+  __device__ __host__
+  static int side_of_begin(int d, int type) {
+    static const int type_begin[] = {0, 1};
+    static const int begin[] = {
+      0, 2, 2
+    };
+    return begin[type_begin[d] + type];
+  }
+};
+
+template <>
+struct unit_simplex_table<2> {
+  __device__ __host__
+  static int ntypes(int d, int scope = ELEMENT_SCOPE_ALL) {
+    static const int n[] = {1, 3, 2, 1, 1, 0, 0, 2, 2};
+    return n[scope * 3 + d];
+  }
+
+  __device__ __host__
+  static int scoped_type(int d, int scope, int i) {
+    static const int types[] = {0, 1, 0, 2, 0, 1};
+    static const int begin[] = {0, 1, 2, 2, 2, 4};
+    return scope == ELEMENT_SCOPE_ALL ? i : types[begin[(scope - 1) * 3 + d] + i];
+  }
+
+  __device__ __host__
+  static const int* offsets(int d, int type) {
+    static const int o[] = {
+      0, 0, 0, 0, 0, 1, 0, 0, 
+      1, 0, 0, 0, 1, 1, 0, 0, 
+      0, 1, 1, 1, 0, 0, 1, 0, 
+      1, 1
+    };
+    static const int begin[] = {0, 2, 14};
+    return o + begin[d] + type * (d + 1) * 2;
+  }
+
+  __device__ __host__
+  static int nsides(int d) {return d > 0 ? d + 1 : 0;}
+
+  __device__ __host__
+  static const int* sides(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 
+      0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0, 1, 
+      2, 0, 0, 0, 1, 0, 1, 0, 0, 2, 0, 0
+    };
+    static const int begin[] = {0, 0, 18};
+    return s + begin[d] + type * (d + 1) * 3;
+  }
+
+  __device__ __host__
+  static int nside_of(int d, int type) {return side_of_begin(d, type + 1) - side_of_begin(d, type);}
+
+  __device__ __host__
+  static const int* side_of(int d, int type) {
+    static const int s[] = {
+      0, 0, -1, 0, 0, 0, 1, -1, 0, 1, 0, 0, 
+      2, -1, -1, 2, 0, 0, 0, 0, 0, 1, -1, 0, 
+      0, 0, -1, 1, 0, 0, 0, 0, 0, 1, 0, 0
+    };
+    return s + side_of_begin(d, type) * 3;
+  }
+
+private:
+  __device__ __host__
+  static int side_of_begin(int d, int type) {
+    static const int type_begin[] = {0, 1, 4};
+    static const int begin[] = {
+      0, 6, 8, 10, 12, 12, 12
+    };
+    return begin[type_begin[d] + type];
+  }
+};
+
+template <>
+struct unit_simplex_table<3> {
+  __device__ __host__
+  static int ntypes(int d, int scope = ELEMENT_SCOPE_ALL) {
+    static const int n[] = {1, 7, 12, 6, 1, 3, 2, 0, 0, 4, 10, 6};
+    return n[scope * 4 + d];
+  }
+
+  __device__ __host__
+  static int scoped_type(int d, int scope, int i) {
+    static const int types[] = {0, 1, 3, 5, 4, 8, 0, 2, 4, 6, 0, 1, 2, 3, 5, 6, 7, 9, 10, 11, 0, 1, 2, 3, 4, 5};
+    static const int begin[] = {0, 1, 4, 6, 6, 6, 10, 20};
+    return scope == ELEMENT_SCOPE_ALL ? i : types[begin[(scope - 1) * 4 + d] + i];
+  }
+
+  __device__ __host__
+  static const int* offsets(int d, int type) {
+    static const int o[] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      0, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 
+      1, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 
+      1, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 
+      0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 
+      1, 0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 
+      0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 
+      0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 
+      1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 
+      0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 
+      1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 
+      1, 1, 1, 0, 0, 0, 1, 0, 1, 1, 1, 1, 
+      0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 0, 0, 
+      0, 0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 
+      0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 
+      0, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 
+      0, 1, 0, 1, 1, 0, 1, 1, 1, 0, 0, 0, 
+      1, 0, 0, 1, 0, 1, 1, 1, 1, 0, 0, 0, 
+      1, 0, 0, 1, 1, 0, 1, 1, 1
+    };
+    static const int begin[] = {0, 3, 45, 153};
+    return o + begin[d] + type * (d + 1) * 3;
+  }
+
+  __device__ __host__
+  static int nsides(int d) {return d > 0 ? d + 1 : 0;}
+
+  __device__ __host__
+  static const int* sides(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 
+      0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 
+      0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 1, 0, 
+      0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 
+      2, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0, 1, 4, 0, 0, 0, 
+      0, 0, 0, 0, 5, 0, 0, 1, 6, 0, 0, 0, 0, 0, 1, 0, 
+      1, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 3, 0, 1, 0, 
+      5, 0, 0, 0, 1, 0, 0, 0, 4, 0, 1, 0, 6, 0, 0, 0, 
+      2, 0, 0, 0, 3, 0, 1, 1, 6, 0, 0, 0, 0, 1, 0, 0, 
+      3, 0, 0, 0, 4, 0, 0, 0, 1, 1, 0, 0, 3, 0, 0, 0, 
+      5, 0, 0, 0, 2, 1, 0, 0, 3, 0, 0, 0, 6, 0, 0, 0, 
+      1, 1, 0, 1, 4, 0, 0, 0, 6, 0, 0, 0, 0, 1, 1, 0, 
+      5, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 
+      4, 0, 0, 1, 6, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 
+      8, 0, 0, 1, 10, 0, 0, 0, 1, 0, 1, 0, 3, 0, 0, 0, 
+      5, 0, 0, 0, 6, 0, 0, 0, 4, 0, 0, 0, 5, 0, 0, 0, 
+      7, 0, 1, 0, 11, 0, 0, 0, 0, 1, 0, 0, 7, 0, 0, 0, 
+      9, 0, 0, 0, 10, 0, 0, 0, 3, 1, 0, 0, 8, 0, 0, 0, 
+      9, 0, 0, 0, 11, 0, 0, 0
+    };
+    static const int begin[] = {0, 0, 56, 200};
+    return s + begin[d] + type * (d + 1) * 4;
+  }
+
+  __device__ __host__
+  static int nside_of(int d, int type) {return side_of_begin(d, type + 1) - side_of_begin(d, type);}
+
+  __device__ __host__
+  static const int* side_of(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, -1, 0, 0, 0, 0, 1, 0, -1, 0, 1, 0, 0, 0, 
+      2, 0, -1, -1, 2, 0, 0, 0, 3, -1, 0, 0, 3, 0, 0, 0, 
+      4, -1, 0, -1, 4, 0, 0, 0, 5, -1, -1, 0, 5, 0, 0, 0, 
+      6, -1, -1, -1, 6, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      2, 0, 0, 0, 3, 0, -1, 0, 7, -1, 0, 0, 11, -1, -1, 0, 
+      0, 0, 0, -1, 3, 0, 0, 0, 4, 0, 0, 0, 5, 0, 0, 0, 
+      8, -1, 0, 0, 10, -1, 0, -1, 0, 0, 0, 0, 3, 0, 0, 0, 
+      6, 0, 0, 0, 9, -1, 0, 0, 1, 0, 0, -1, 4, 0, -1, 0, 
+      6, 0, -1, -1, 7, 0, 0, 0, 8, 0, 0, 0, 9, 0, 0, 0, 
+      1, 0, 0, 0, 5, 0, -1, 0, 7, 0, 0, 0, 10, 0, 0, 0, 
+      2, 0, 0, -1, 4, 0, 0, 0, 8, 0, 0, 0, 11, 0, 0, 0, 
+      2, 0, 0, 0, 5, 0, 0, 0, 6, 0, 0, 0, 9, 0, 0, 0, 
+      10, 0, 0, 0, 11, 0, 0, 0, 0, 0, 0, 0, 4, -1, 0, 0, 
+      1, 0, 0, 0, 2, 0, -1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      2, 0, 0, 0, 5, -1, 0, 0, 0, 0, 0, -1, 3, 0, 0, 0, 
+      2, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 
+      3, 0, -1, 0, 4, 0, 0, 0, 1, 0, 0, -1, 5, 0, 0, 0, 
+      4, 0, 0, 0, 5, 0, 0, 0, 1, 0, 0, 0, 4, 0, 0, 0, 
+      3, 0, 0, 0, 5, 0, 0, 0
+    };
+    return s + side_of_begin(d, type) * 4;
+  }
+
+private:
+  __device__ __host__
+  static int side_of_begin(int d, int type) {
+    static const int type_begin[] = {0, 1, 8, 20};
+    static const int begin[] = {
+      0, 14, 20, 26, 30, 36, 40, 44, 50, 52, 54, 56, 58, 60, 62, 64, 
+      66, 68, 70, 72, 74, 74, 74, 74, 74, 74, 74
+    };
+    return begin[type_begin[d] + type];
+  }
+};
+
+template <>
+struct unit_simplex_table<4> {
+  __device__ __host__
+  static int ntypes(int d, int scope = ELEMENT_SCOPE_ALL) {
+    static const int n[] = {1, 15, 50, 60, 24, 1, 7, 12, 6, 0, 0, 8, 38, 54, 24};
+    return n[scope * 5 + d];
+  }
+
+  __device__ __host__
+  static int scoped_type(int d, int scope, int i) {
+    static const int types[] = {0, 1, 3, 5, 7, 9, 11, 13, 8, 10, 12, 18, 20, 22, 28, 32, 34, 36, 42, 46, 16, 20, 30, 34, 46, 50, 0, 2, 4, 6, 8, 10, 12, 14, 0, 1, 2, 3, 4, 5, 6, 7, 9, 11, 13, 14, 15, 16, 17, 19, 21, 23, 24, 25, 26, 27, 29, 30, 31, 33, 35, 37, 38, 39, 40, 41, 43, 44, 45, 47, 48, 49, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17, 18, 19, 21, 22, 23, 24, 25, 26, 27, 28, 29, 31, 32, 33, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 47, 48, 49, 51, 52, 53, 54, 55, 56, 57, 58, 59, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23};
+    static const int begin[] = {0, 1, 8, 20, 26, 26, 26, 34, 72, 126};
+    return scope == ELEMENT_SCOPE_ALL ? i : types[begin[(scope - 1) * 5 + d] + i];
+  }
+
+  __device__ __host__
+  static const int* offsets(int d, int type) {
+    static const int o[] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 
+      0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 
+      0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 
+      0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 
+      1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 
+      1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 
+      0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 
+      0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 
+      0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 
+      0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 0, 0, 0, 0, 
+      0, 0, 1, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 0, 0, 0, 0, 
+      0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 
+      0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 
+      0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 
+      0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 
+      0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 1, 0, 1, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 0, 0, 
+      0, 1, 1, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 
+      1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 
+      0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 
+      1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 
+      0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 
+      1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 
+      1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 
+      0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      1, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 
+      1, 1, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 
+      0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 
+      1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 
+      1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 
+      1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 
+      1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 
+      0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 
+      1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 
+      1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 
+      1, 1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 
+      1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 
+      1, 1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 
+      1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 
+      0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 
+      0, 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 
+      1, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 
+      1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 1, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 
+      0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 
+      0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 
+      0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 
+      0, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 
+      0, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 
+      1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 
+      1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 1, 
+      1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 
+      1, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 
+      1, 0, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 0, 
+      1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 
+      0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 
+      1, 1, 1, 1
+    };
+    static const int begin[] = {0, 4, 124, 724, 1684};
+    return o + begin[d] + type * (d + 1) * 4;
+  }
+
+  __device__ __host__
+  static int nsides(int d) {return d > 0 ? d + 1 : 0;}
+
+  __device__ __host__
+  static const int* sides(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 
+      0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 
+      0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 
+      0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 
+      0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 
+      0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 
+      0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 
+      2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0, 0, 1, 4, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 5, 0, 0, 0, 1, 6, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
+      7, 0, 0, 0, 1, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 0, 0, 0, 1, 
+      10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 11, 0, 0, 0, 1, 12, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 13, 0, 0, 0, 1, 14, 0, 0, 0, 0, 0, 0, 0, 1, 0, 
+      1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 1, 0, 0, 0, 0, 3, 0, 0, 1, 0, 
+      5, 0, 0, 0, 0, 1, 0, 0, 0, 0, 4, 0, 0, 1, 0, 6, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 7, 0, 0, 1, 0, 9, 0, 0, 0, 0, 1, 0, 0, 0, 0, 
+      8, 0, 0, 1, 0, 10, 0, 0, 0, 0, 1, 0, 0, 0, 0, 11, 0, 0, 1, 0, 
+      13, 0, 0, 0, 0, 1, 0, 0, 0, 0, 12, 0, 0, 1, 0, 14, 0, 0, 0, 0, 
+      2, 0, 0, 0, 0, 3, 0, 0, 1, 1, 6, 0, 0, 0, 0, 2, 0, 0, 0, 0, 
+      7, 0, 0, 1, 1, 10, 0, 0, 0, 0, 2, 0, 0, 0, 0, 11, 0, 0, 1, 1, 
+      14, 0, 0, 0, 0, 0, 0, 1, 0, 0, 3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 
+      1, 0, 1, 0, 0, 3, 0, 0, 0, 0, 5, 0, 0, 0, 0, 2, 0, 1, 0, 0, 
+      3, 0, 0, 0, 0, 6, 0, 0, 0, 0, 3, 0, 0, 0, 0, 7, 0, 1, 0, 0, 
+      11, 0, 0, 0, 0, 3, 0, 0, 0, 0, 8, 0, 1, 0, 0, 12, 0, 0, 0, 0, 
+      3, 0, 0, 0, 0, 9, 0, 1, 0, 0, 13, 0, 0, 0, 0, 3, 0, 0, 0, 0, 
+      10, 0, 1, 0, 0, 14, 0, 0, 0, 0, 1, 0, 1, 0, 1, 4, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 4, 0, 0, 0, 0, 7, 0, 1, 0, 1, 12, 0, 0, 0, 0, 
+      4, 0, 0, 0, 0, 9, 0, 1, 0, 1, 14, 0, 0, 0, 0, 0, 0, 1, 1, 0, 
+      5, 0, 0, 0, 0, 6, 0, 0, 0, 0, 5, 0, 0, 0, 0, 7, 0, 1, 1, 0, 
+      13, 0, 0, 0, 0, 5, 0, 0, 0, 0, 8, 0, 1, 1, 0, 14, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 7, 0, 1, 1, 1, 14, 0, 0, 0, 0, 0, 1, 0, 0, 0, 
+      7, 0, 0, 0, 0, 8, 0, 0, 0, 0, 1, 1, 0, 0, 0, 7, 0, 0, 0, 0, 
+      9, 0, 0, 0, 0, 2, 1, 0, 0, 0, 7, 0, 0, 0, 0, 10, 0, 0, 0, 0, 
+      3, 1, 0, 0, 0, 7, 0, 0, 0, 0, 11, 0, 0, 0, 0, 4, 1, 0, 0, 0, 
+      7, 0, 0, 0, 0, 12, 0, 0, 0, 0, 5, 1, 0, 0, 0, 7, 0, 0, 0, 0, 
+      13, 0, 0, 0, 0, 6, 1, 0, 0, 0, 7, 0, 0, 0, 0, 14, 0, 0, 0, 0, 
+      1, 1, 0, 0, 1, 8, 0, 0, 0, 0, 10, 0, 0, 0, 0, 3, 1, 0, 0, 1, 
+      8, 0, 0, 0, 0, 12, 0, 0, 0, 0, 5, 1, 0, 0, 1, 8, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 0, 1, 0, 1, 0, 9, 0, 0, 0, 0, 10, 0, 0, 0, 0, 
+      3, 1, 0, 1, 0, 9, 0, 0, 0, 0, 13, 0, 0, 0, 0, 4, 1, 0, 1, 0, 
+      9, 0, 0, 0, 0, 14, 0, 0, 0, 0, 3, 1, 0, 1, 1, 10, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 0, 1, 1, 0, 0, 11, 0, 0, 0, 0, 12, 0, 0, 0, 0, 
+      1, 1, 1, 0, 0, 11, 0, 0, 0, 0, 13, 0, 0, 0, 0, 2, 1, 1, 0, 0, 
+      11, 0, 0, 0, 0, 14, 0, 0, 0, 0, 1, 1, 1, 0, 1, 12, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 0, 1, 1, 1, 0, 13, 0, 0, 0, 0, 14, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 8, 0, 0, 0, 1, 14, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 10, 0, 0, 0, 1, 15, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 6, 0, 0, 0, 0, 12, 0, 0, 0, 1, 16, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 18, 0, 0, 0, 1, 24, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 5, 0, 0, 0, 0, 20, 0, 0, 0, 1, 25, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 6, 0, 0, 0, 0, 22, 0, 0, 0, 1, 26, 0, 0, 0, 0, 
+      2, 0, 0, 0, 0, 6, 0, 0, 0, 0, 28, 0, 0, 0, 1, 30, 0, 0, 0, 0, 
+      3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 32, 0, 0, 0, 1, 38, 0, 0, 0, 0, 
+      3, 0, 0, 0, 0, 5, 0, 0, 0, 0, 34, 0, 0, 0, 1, 39, 0, 0, 0, 0, 
+      3, 0, 0, 0, 0, 6, 0, 0, 0, 0, 36, 0, 0, 0, 1, 40, 0, 0, 0, 0, 
+      4, 0, 0, 0, 0, 6, 0, 0, 0, 0, 42, 0, 0, 0, 1, 44, 0, 0, 0, 0, 
+      5, 0, 0, 0, 0, 6, 0, 0, 0, 0, 46, 0, 0, 0, 1, 48, 0, 0, 0, 0, 
+      1, 0, 0, 1, 0, 7, 0, 0, 0, 0, 9, 0, 0, 0, 0, 14, 0, 0, 0, 0, 
+      3, 0, 0, 1, 0, 7, 0, 0, 0, 0, 11, 0, 0, 0, 0, 15, 0, 0, 0, 0, 
+      5, 0, 0, 1, 0, 7, 0, 0, 0, 0, 13, 0, 0, 0, 0, 16, 0, 0, 0, 0, 
+      8, 0, 0, 0, 0, 9, 0, 0, 0, 0, 17, 0, 0, 1, 0, 27, 0, 0, 0, 0, 
+      8, 0, 0, 0, 0, 12, 0, 0, 0, 0, 20, 0, 0, 1, 0, 28, 0, 0, 0, 0, 
+      8, 0, 0, 0, 0, 13, 0, 0, 0, 0, 21, 0, 0, 1, 0, 29, 0, 0, 0, 0, 
+      9, 0, 0, 0, 0, 13, 0, 0, 0, 0, 25, 0, 0, 1, 0, 30, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 11, 0, 0, 0, 0, 31, 0, 0, 1, 0, 41, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 12, 0, 0, 0, 0, 34, 0, 0, 1, 0, 42, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 13, 0, 0, 0, 0, 35, 0, 0, 1, 0, 43, 0, 0, 0, 0, 
+      11, 0, 0, 0, 0, 13, 0, 0, 0, 0, 39, 0, 0, 1, 0, 44, 0, 0, 0, 0, 
+      12, 0, 0, 0, 0, 13, 0, 0, 0, 0, 45, 0, 0, 1, 0, 49, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 16, 0, 0, 0, 0, 20, 0, 0, 1, 1, 30, 0, 0, 0, 0, 
+      15, 0, 0, 0, 0, 16, 0, 0, 0, 0, 34, 0, 0, 1, 1, 44, 0, 0, 0, 0, 
+      0, 0, 1, 0, 0, 17, 0, 0, 0, 0, 19, 0, 0, 0, 0, 24, 0, 0, 0, 0, 
+      3, 0, 1, 0, 0, 17, 0, 0, 0, 0, 21, 0, 0, 0, 0, 25, 0, 0, 0, 0, 
+      4, 0, 1, 0, 0, 17, 0, 0, 0, 0, 23, 0, 0, 0, 0, 26, 0, 0, 0, 0, 
+      7, 0, 1, 0, 0, 18, 0, 0, 0, 0, 19, 0, 0, 0, 0, 27, 0, 0, 0, 0, 
+      10, 0, 1, 0, 0, 18, 0, 0, 0, 0, 22, 0, 0, 0, 0, 28, 0, 0, 0, 0, 
+      11, 0, 1, 0, 0, 18, 0, 0, 0, 0, 23, 0, 0, 0, 0, 29, 0, 0, 0, 0, 
+      15, 0, 1, 0, 0, 19, 0, 0, 0, 0, 23, 0, 0, 0, 0, 30, 0, 0, 0, 0, 
+      20, 0, 0, 0, 0, 21, 0, 0, 0, 0, 31, 0, 1, 0, 0, 45, 0, 0, 0, 0, 
+      20, 0, 0, 0, 0, 22, 0, 0, 0, 0, 32, 0, 1, 0, 0, 46, 0, 0, 0, 0, 
+      20, 0, 0, 0, 0, 23, 0, 0, 0, 0, 33, 0, 1, 0, 0, 47, 0, 0, 0, 0, 
+      21, 0, 0, 0, 0, 23, 0, 0, 0, 0, 38, 0, 1, 0, 0, 48, 0, 0, 0, 0, 
+      22, 0, 0, 0, 0, 23, 0, 0, 0, 0, 41, 0, 1, 0, 0, 49, 0, 0, 0, 0, 
+      10, 0, 1, 0, 1, 24, 0, 0, 0, 0, 26, 0, 0, 0, 0, 30, 0, 0, 0, 0, 
+      25, 0, 0, 0, 0, 26, 0, 0, 0, 0, 32, 0, 1, 0, 1, 48, 0, 0, 0, 0, 
+      3, 0, 1, 1, 0, 27, 0, 0, 0, 0, 29, 0, 0, 0, 0, 30, 0, 0, 0, 0, 
+      28, 0, 0, 0, 0, 29, 0, 0, 0, 0, 31, 0, 1, 1, 0, 49, 0, 0, 0, 0, 
+      0, 1, 0, 0, 0, 31, 0, 0, 0, 0, 33, 0, 0, 0, 0, 38, 0, 0, 0, 0, 
+      1, 1, 0, 0, 0, 31, 0, 0, 0, 0, 35, 0, 0, 0, 0, 39, 0, 0, 0, 0, 
+      2, 1, 0, 0, 0, 31, 0, 0, 0, 0, 37, 0, 0, 0, 0, 40, 0, 0, 0, 0, 
+      7, 1, 0, 0, 0, 32, 0, 0, 0, 0, 33, 0, 0, 0, 0, 41, 0, 0, 0, 0, 
+      8, 1, 0, 0, 0, 32, 0, 0, 0, 0, 36, 0, 0, 0, 0, 42, 0, 0, 0, 0, 
+      9, 1, 0, 0, 0, 32, 0, 0, 0, 0, 37, 0, 0, 0, 0, 43, 0, 0, 0, 0, 
+      14, 1, 0, 0, 0, 33, 0, 0, 0, 0, 37, 0, 0, 0, 0, 44, 0, 0, 0, 0, 
+      17, 1, 0, 0, 0, 34, 0, 0, 0, 0, 35, 0, 0, 0, 0, 45, 0, 0, 0, 0, 
+      18, 1, 0, 0, 0, 34, 0, 0, 0, 0, 36, 0, 0, 0, 0, 46, 0, 0, 0, 0, 
+      19, 1, 0, 0, 0, 34, 0, 0, 0, 0, 37, 0, 0, 0, 0, 47, 0, 0, 0, 0, 
+      24, 1, 0, 0, 0, 35, 0, 0, 0, 0, 37, 0, 0, 0, 0, 48, 0, 0, 0, 0, 
+      27, 1, 0, 0, 0, 36, 0, 0, 0, 0, 37, 0, 0, 0, 0, 49, 0, 0, 0, 0, 
+      8, 1, 0, 0, 1, 38, 0, 0, 0, 0, 40, 0, 0, 0, 0, 44, 0, 0, 0, 0, 
+      18, 1, 0, 0, 1, 39, 0, 0, 0, 0, 40, 0, 0, 0, 0, 48, 0, 0, 0, 0, 
+      1, 1, 0, 1, 0, 41, 0, 0, 0, 0, 43, 0, 0, 0, 0, 44, 0, 0, 0, 0, 
+      17, 1, 0, 1, 0, 42, 0, 0, 0, 0, 43, 0, 0, 0, 0, 49, 0, 0, 0, 0, 
+      0, 1, 1, 0, 0, 45, 0, 0, 0, 0, 47, 0, 0, 0, 0, 48, 0, 0, 0, 0, 
+      7, 1, 1, 0, 0, 46, 0, 0, 0, 0, 47, 0, 0, 0, 0, 49, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 6, 0, 0, 0, 0, 16, 0, 0, 0, 1, 
+      24, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 10, 0, 0, 0, 0, 
+      20, 0, 0, 0, 1, 25, 0, 0, 0, 0, 3, 0, 0, 0, 0, 5, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 30, 0, 0, 0, 1, 38, 0, 0, 0, 0, 4, 0, 0, 0, 0, 
+      5, 0, 0, 0, 0, 11, 0, 0, 0, 0, 34, 0, 0, 0, 1, 39, 0, 0, 0, 0, 
+      7, 0, 0, 0, 0, 9, 0, 0, 0, 0, 10, 0, 0, 0, 0, 46, 0, 0, 0, 1, 
+      54, 0, 0, 0, 0, 8, 0, 0, 0, 0, 9, 0, 0, 0, 0, 11, 0, 0, 0, 0, 
+      50, 0, 0, 0, 1, 55, 0, 0, 0, 0, 4, 0, 0, 1, 0, 12, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 18, 0, 0, 0, 0, 24, 0, 0, 0, 0, 8, 0, 0, 1, 0, 
+      13, 0, 0, 0, 0, 14, 0, 0, 0, 0, 22, 0, 0, 0, 0, 25, 0, 0, 0, 0, 
+      15, 0, 0, 0, 0, 17, 0, 0, 0, 0, 18, 0, 0, 0, 0, 27, 0, 0, 1, 0, 
+      40, 0, 0, 0, 0, 16, 0, 0, 0, 0, 17, 0, 0, 0, 0, 23, 0, 0, 0, 0, 
+      33, 0, 0, 1, 0, 41, 0, 0, 0, 0, 19, 0, 0, 0, 0, 21, 0, 0, 0, 0, 
+      22, 0, 0, 0, 0, 43, 0, 0, 1, 0, 56, 0, 0, 0, 0, 20, 0, 0, 0, 0, 
+      21, 0, 0, 0, 0, 23, 0, 0, 0, 0, 49, 0, 0, 1, 0, 57, 0, 0, 0, 0, 
+      1, 0, 1, 0, 0, 26, 0, 0, 0, 0, 28, 0, 0, 0, 0, 32, 0, 0, 0, 0, 
+      38, 0, 0, 0, 0, 7, 0, 1, 0, 0, 27, 0, 0, 0, 0, 28, 0, 0, 0, 0, 
+      36, 0, 0, 0, 0, 39, 0, 0, 0, 0, 13, 0, 1, 0, 0, 29, 0, 0, 0, 0, 
+      31, 0, 0, 0, 0, 32, 0, 0, 0, 0, 40, 0, 0, 0, 0, 19, 0, 1, 0, 0, 
+      30, 0, 0, 0, 0, 31, 0, 0, 0, 0, 37, 0, 0, 0, 0, 41, 0, 0, 0, 0, 
+      33, 0, 0, 0, 0, 35, 0, 0, 0, 0, 36, 0, 0, 0, 0, 42, 0, 1, 0, 0, 
+      58, 0, 0, 0, 0, 34, 0, 0, 0, 0, 35, 0, 0, 0, 0, 37, 0, 0, 0, 0, 
+      45, 0, 1, 0, 0, 59, 0, 0, 0, 0, 0, 1, 0, 0, 0, 42, 0, 0, 0, 0, 
+      44, 0, 0, 0, 0, 48, 0, 0, 0, 0, 54, 0, 0, 0, 0, 3, 1, 0, 0, 0, 
+      43, 0, 0, 0, 0, 44, 0, 0, 0, 0, 52, 0, 0, 0, 0, 55, 0, 0, 0, 0, 
+      12, 1, 0, 0, 0, 45, 0, 0, 0, 0, 47, 0, 0, 0, 0, 48, 0, 0, 0, 0, 
+      56, 0, 0, 0, 0, 15, 1, 0, 0, 0, 46, 0, 0, 0, 0, 47, 0, 0, 0, 0, 
+      53, 0, 0, 0, 0, 57, 0, 0, 0, 0, 26, 1, 0, 0, 0, 49, 0, 0, 0, 0, 
+      51, 0, 0, 0, 0, 52, 0, 0, 0, 0, 58, 0, 0, 0, 0, 29, 1, 0, 0, 0, 
+      50, 0, 0, 0, 0, 51, 0, 0, 0, 0, 53, 0, 0, 0, 0, 59, 0, 0, 0, 0
+    };
+    static const int begin[] = {0, 0, 150, 900, 2100};
+    return s + begin[d] + type * (d + 1) * 5;
+  }
+
+  __device__ __host__
+  static int nside_of(int d, int type) {return side_of_begin(d, type + 1) - side_of_begin(d, type);}
+
+  __device__ __host__
+  static const int* side_of(int d, int type) {
+    static const int s[] = {
+      0, 0, 0, 0, -1, 0, 0, 0, 0, 0, 1, 0, 0, -1, 0, 1, 0, 0, 0, 0, 
+      2, 0, 0, -1, -1, 2, 0, 0, 0, 0, 3, 0, -1, 0, 0, 3, 0, 0, 0, 0, 
+      4, 0, -1, 0, -1, 4, 0, 0, 0, 0, 5, 0, -1, -1, 0, 5, 0, 0, 0, 0, 
+      6, 0, -1, -1, -1, 6, 0, 0, 0, 0, 7, -1, 0, 0, 0, 7, 0, 0, 0, 0, 
+      8, -1, 0, 0, -1, 8, 0, 0, 0, 0, 9, -1, 0, -1, 0, 9, 0, 0, 0, 0, 
+      10, -1, 0, -1, -1, 10, 0, 0, 0, 0, 11, -1, -1, 0, 0, 11, 0, 0, 0, 0, 
+      12, -1, -1, 0, -1, 12, 0, 0, 0, 0, 13, -1, -1, -1, 0, 13, 0, 0, 0, 0, 
+      14, -1, -1, -1, -1, 14, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 
+      2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 5, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 7, 0, 0, -1, 0, 17, 0, -1, 0, 0, 27, 0, -1, -1, 0, 
+      31, -1, 0, 0, 0, 41, -1, 0, -1, 0, 45, -1, -1, 0, 0, 49, -1, -1, -1, 0, 
+      0, 0, 0, 0, -1, 7, 0, 0, 0, 0, 8, 0, 0, 0, 0, 9, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 11, 0, 0, 0, 0, 12, 0, 0, 0, 0, 13, 0, 0, 0, 0, 
+      18, 0, -1, 0, 0, 24, 0, -1, 0, -1, 32, -1, 0, 0, 0, 38, -1, 0, 0, -1, 
+      46, -1, -1, 0, 0, 48, -1, -1, 0, -1, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 
+      14, 0, 0, 0, 0, 15, 0, 0, 0, 0, 16, 0, 0, 0, 0, 19, 0, -1, 0, 0, 
+      33, -1, 0, 0, 0, 47, -1, -1, 0, 0, 1, 0, 0, 0, -1, 8, 0, 0, -1, 0, 
+      14, 0, 0, -1, -1, 17, 0, 0, 0, 0, 18, 0, 0, 0, 0, 19, 0, 0, 0, 0, 
+      20, 0, 0, 0, 0, 21, 0, 0, 0, 0, 22, 0, 0, 0, 0, 23, 0, 0, 0, 0, 
+      34, -1, 0, 0, 0, 39, -1, 0, 0, -1, 42, -1, 0, -1, 0, 44, -1, 0, -1, -1, 
+      1, 0, 0, 0, 0, 9, 0, 0, -1, 0, 17, 0, 0, 0, 0, 24, 0, 0, 0, 0, 
+      25, 0, 0, 0, 0, 26, 0, 0, 0, 0, 35, -1, 0, 0, 0, 43, -1, 0, -1, 0, 
+      2, 0, 0, 0, -1, 8, 0, 0, 0, 0, 18, 0, 0, 0, 0, 27, 0, 0, 0, 0, 
+      28, 0, 0, 0, 0, 29, 0, 0, 0, 0, 36, -1, 0, 0, 0, 40, -1, 0, 0, -1, 
+      2, 0, 0, 0, 0, 9, 0, 0, 0, 0, 14, 0, 0, 0, 0, 19, 0, 0, 0, 0, 
+      24, 0, 0, 0, 0, 27, 0, 0, 0, 0, 30, 0, 0, 0, 0, 37, -1, 0, 0, 0, 
+      3, 0, 0, 0, -1, 10, 0, 0, -1, 0, 15, 0, 0, -1, -1, 20, 0, -1, 0, 0, 
+      25, 0, -1, 0, -1, 28, 0, -1, -1, 0, 30, 0, -1, -1, -1, 31, 0, 0, 0, 0, 
+      32, 0, 0, 0, 0, 33, 0, 0, 0, 0, 34, 0, 0, 0, 0, 35, 0, 0, 0, 0, 
+      36, 0, 0, 0, 0, 37, 0, 0, 0, 0, 3, 0, 0, 0, 0, 11, 0, 0, -1, 0, 
+      21, 0, -1, 0, 0, 29, 0, -1, -1, 0, 31, 0, 0, 0, 0, 38, 0, 0, 0, 0, 
+      39, 0, 0, 0, 0, 40, 0, 0, 0, 0, 4, 0, 0, 0, -1, 10, 0, 0, 0, 0, 
+      22, 0, -1, 0, 0, 26, 0, -1, 0, -1, 32, 0, 0, 0, 0, 41, 0, 0, 0, 0, 
+      42, 0, 0, 0, 0, 43, 0, 0, 0, 0, 4, 0, 0, 0, 0, 11, 0, 0, 0, 0, 
+      15, 0, 0, 0, 0, 23, 0, -1, 0, 0, 33, 0, 0, 0, 0, 38, 0, 0, 0, 0, 
+      41, 0, 0, 0, 0, 44, 0, 0, 0, 0, 5, 0, 0, 0, -1, 12, 0, 0, -1, 0, 
+      16, 0, 0, -1, -1, 20, 0, 0, 0, 0, 34, 0, 0, 0, 0, 45, 0, 0, 0, 0, 
+      46, 0, 0, 0, 0, 47, 0, 0, 0, 0, 5, 0, 0, 0, 0, 13, 0, 0, -1, 0, 
+      21, 0, 0, 0, 0, 25, 0, 0, 0, 0, 35, 0, 0, 0, 0, 39, 0, 0, 0, 0, 
+      45, 0, 0, 0, 0, 48, 0, 0, 0, 0, 6, 0, 0, 0, -1, 12, 0, 0, 0, 0, 
+      22, 0, 0, 0, 0, 28, 0, 0, 0, 0, 36, 0, 0, 0, 0, 42, 0, 0, 0, 0, 
+      46, 0, 0, 0, 0, 49, 0, 0, 0, 0, 6, 0, 0, 0, 0, 13, 0, 0, 0, 0, 
+      16, 0, 0, 0, 0, 23, 0, 0, 0, 0, 26, 0, 0, 0, 0, 29, 0, 0, 0, 0, 
+      30, 0, 0, 0, 0, 37, 0, 0, 0, 0, 40, 0, 0, 0, 0, 43, 0, 0, 0, 0, 
+      44, 0, 0, 0, 0, 47, 0, 0, 0, 0, 48, 0, 0, 0, 0, 49, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 26, 0, -1, 0, 0, 
+      42, -1, 0, 0, 0, 58, -1, -1, 0, 0, 3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 
+      5, 0, 0, 0, 0, 12, 0, 0, -1, 0, 43, -1, 0, 0, 0, 56, -1, 0, -1, 0, 
+      0, 0, 0, 0, 0, 3, 0, 0, 0, 0, 6, 0, 0, 0, 0, 44, -1, 0, 0, 0, 
+      7, 0, 0, 0, 0, 8, 0, 0, 0, 0, 9, 0, 0, 0, 0, 13, 0, 0, -1, 0, 
+      27, 0, -1, 0, 0, 40, 0, -1, -1, 0, 1, 0, 0, 0, 0, 7, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 28, 0, -1, 0, 0, 4, 0, 0, 0, 0, 8, 0, 0, 0, 0, 
+      11, 0, 0, 0, 0, 14, 0, 0, -1, 0, 2, 0, 0, 0, 0, 5, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 9, 0, 0, 0, 0, 10, 0, 0, 0, 0, 11, 0, 0, 0, 0, 
+      12, 0, 0, 0, 0, 13, 0, 0, 0, 0, 14, 0, 0, 0, 0, 29, 0, -1, 0, 0, 
+      45, -1, 0, 0, 0, 59, -1, -1, 0, 0, 0, 0, 0, 0, -1, 15, 0, 0, 0, 0, 
+      16, 0, 0, 0, 0, 17, 0, 0, 0, 0, 46, -1, 0, 0, 0, 54, -1, 0, 0, -1, 
+      12, 0, 0, 0, 0, 15, 0, 0, 0, 0, 18, 0, 0, 0, 0, 47, -1, 0, 0, 0, 
+      1, 0, 0, 0, -1, 19, 0, 0, 0, 0, 20, 0, 0, 0, 0, 21, 0, 0, 0, 0, 
+      30, 0, -1, 0, 0, 38, 0, -1, 0, -1, 13, 0, 0, 0, 0, 19, 0, 0, 0, 0, 
+      22, 0, 0, 0, 0, 31, 0, -1, 0, 0, 2, 0, 0, 0, -1, 16, 0, 0, 0, 0, 
+      20, 0, 0, 0, 0, 23, 0, 0, 0, 0, 14, 0, 0, 0, 0, 17, 0, 0, 0, 0, 
+      18, 0, 0, 0, 0, 21, 0, 0, 0, 0, 22, 0, 0, 0, 0, 23, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 12, 0, 0, 0, 0, 24, 0, 0, 0, 0, 48, -1, 0, 0, 0, 
+      1, 0, 0, 0, 0, 13, 0, 0, 0, 0, 25, 0, 0, 0, 0, 32, 0, -1, 0, 0, 
+      2, 0, 0, 0, 0, 14, 0, 0, 0, 0, 24, 0, 0, 0, 0, 25, 0, 0, 0, 0, 
+      15, 0, 0, -1, 0, 26, 0, 0, 0, 0, 27, 0, 0, 0, 0, 28, 0, 0, 0, 0, 
+      49, -1, 0, 0, 0, 57, -1, 0, -1, 0, 3, 0, 0, 0, -1, 29, 0, 0, 0, 0, 
+      30, 0, 0, 0, 0, 31, 0, 0, 0, 0, 50, -1, 0, 0, 0, 55, -1, 0, 0, -1, 
+      26, 0, 0, 0, 0, 29, 0, 0, 0, 0, 32, 0, 0, 0, 0, 51, -1, 0, 0, 0, 
+      4, 0, 0, 0, -1, 16, 0, 0, -1, 0, 24, 0, 0, -1, -1, 33, 0, 0, 0, 0, 
+      34, 0, 0, 0, 0, 35, 0, 0, 0, 0, 17, 0, 0, -1, 0, 27, 0, 0, 0, 0, 
+      33, 0, 0, 0, 0, 36, 0, 0, 0, 0, 5, 0, 0, 0, -1, 30, 0, 0, 0, 0, 
+      34, 0, 0, 0, 0, 37, 0, 0, 0, 0, 28, 0, 0, 0, 0, 31, 0, 0, 0, 0, 
+      32, 0, 0, 0, 0, 35, 0, 0, 0, 0, 36, 0, 0, 0, 0, 37, 0, 0, 0, 0, 
+      3, 0, 0, 0, 0, 26, 0, 0, 0, 0, 38, 0, 0, 0, 0, 52, -1, 0, 0, 0, 
+      4, 0, 0, 0, 0, 18, 0, 0, -1, 0, 27, 0, 0, 0, 0, 39, 0, 0, 0, 0, 
+      5, 0, 0, 0, 0, 28, 0, 0, 0, 0, 38, 0, 0, 0, 0, 39, 0, 0, 0, 0, 
+      15, 0, 0, 0, 0, 29, 0, 0, 0, 0, 40, 0, 0, 0, 0, 53, -1, 0, 0, 0, 
+      6, 0, 0, 0, -1, 16, 0, 0, 0, 0, 30, 0, 0, 0, 0, 41, 0, 0, 0, 0, 
+      17, 0, 0, 0, 0, 31, 0, 0, 0, 0, 40, 0, 0, 0, 0, 41, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 18, 0, 0, 0, 0, 24, 0, 0, 0, 0, 32, 0, 0, 0, 0, 
+      38, 0, 0, 0, 0, 40, 0, 0, 0, 0, 19, 0, 0, -1, 0, 33, 0, -1, 0, 0, 
+      41, 0, -1, -1, 0, 42, 0, 0, 0, 0, 43, 0, 0, 0, 0, 44, 0, 0, 0, 0, 
+      7, 0, 0, 0, -1, 34, 0, -1, 0, 0, 39, 0, -1, 0, -1, 45, 0, 0, 0, 0, 
+      46, 0, 0, 0, 0, 47, 0, 0, 0, 0, 35, 0, -1, 0, 0, 42, 0, 0, 0, 0, 
+      45, 0, 0, 0, 0, 48, 0, 0, 0, 0, 8, 0, 0, 0, -1, 20, 0, 0, -1, 0, 
+      25, 0, 0, -1, -1, 49, 0, 0, 0, 0, 50, 0, 0, 0, 0, 51, 0, 0, 0, 0, 
+      21, 0, 0, -1, 0, 43, 0, 0, 0, 0, 49, 0, 0, 0, 0, 52, 0, 0, 0, 0, 
+      9, 0, 0, 0, -1, 46, 0, 0, 0, 0, 50, 0, 0, 0, 0, 53, 0, 0, 0, 0, 
+      44, 0, 0, 0, 0, 47, 0, 0, 0, 0, 48, 0, 0, 0, 0, 51, 0, 0, 0, 0, 
+      52, 0, 0, 0, 0, 53, 0, 0, 0, 0, 7, 0, 0, 0, 0, 36, 0, -1, 0, 0, 
+      42, 0, 0, 0, 0, 54, 0, 0, 0, 0, 8, 0, 0, 0, 0, 22, 0, 0, -1, 0, 
+      43, 0, 0, 0, 0, 55, 0, 0, 0, 0, 9, 0, 0, 0, 0, 44, 0, 0, 0, 0, 
+      54, 0, 0, 0, 0, 55, 0, 0, 0, 0, 19, 0, 0, 0, 0, 37, 0, -1, 0, 0, 
+      45, 0, 0, 0, 0, 56, 0, 0, 0, 0, 10, 0, 0, 0, -1, 20, 0, 0, 0, 0, 
+      46, 0, 0, 0, 0, 57, 0, 0, 0, 0, 21, 0, 0, 0, 0, 47, 0, 0, 0, 0, 
+      56, 0, 0, 0, 0, 57, 0, 0, 0, 0, 10, 0, 0, 0, 0, 22, 0, 0, 0, 0, 
+      25, 0, 0, 0, 0, 48, 0, 0, 0, 0, 54, 0, 0, 0, 0, 56, 0, 0, 0, 0, 
+      23, 0, 0, -1, 0, 33, 0, 0, 0, 0, 49, 0, 0, 0, 0, 58, 0, 0, 0, 0, 
+      11, 0, 0, 0, -1, 34, 0, 0, 0, 0, 50, 0, 0, 0, 0, 59, 0, 0, 0, 0, 
+      35, 0, 0, 0, 0, 51, 0, 0, 0, 0, 58, 0, 0, 0, 0, 59, 0, 0, 0, 0, 
+      11, 0, 0, 0, 0, 36, 0, 0, 0, 0, 39, 0, 0, 0, 0, 52, 0, 0, 0, 0, 
+      55, 0, 0, 0, 0, 58, 0, 0, 0, 0, 23, 0, 0, 0, 0, 37, 0, 0, 0, 0, 
+      41, 0, 0, 0, 0, 53, 0, 0, 0, 0, 57, 0, 0, 0, 0, 59, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 18, -1, 0, 0, 0, 1, 0, 0, 0, 0, 12, 0, -1, 0, 0, 
+      0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 19, -1, 0, 0, 0, 
+      3, 0, 0, 0, 0, 6, 0, 0, -1, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 4, 0, 0, 0, 0, 13, 0, -1, 0, 0, 
+      5, 0, 0, 0, 0, 7, 0, 0, -1, 0, 4, 0, 0, 0, 0, 5, 0, 0, 0, 0, 
+      1, 0, 0, 0, 0, 4, 0, 0, 0, 0, 3, 0, 0, 0, 0, 5, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 20, -1, 0, 0, 0, 7, 0, 0, 0, 0, 14, 0, -1, 0, 0, 
+      6, 0, 0, 0, 0, 7, 0, 0, 0, 0, 8, 0, 0, 0, 0, 21, -1, 0, 0, 0, 
+      0, 0, 0, 0, -1, 9, 0, 0, 0, 0, 8, 0, 0, 0, 0, 9, 0, 0, 0, 0, 
+      6, 0, 0, 0, 0, 8, 0, 0, 0, 0, 10, 0, 0, 0, 0, 15, 0, -1, 0, 0, 
+      1, 0, 0, 0, -1, 11, 0, 0, 0, 0, 10, 0, 0, 0, 0, 11, 0, 0, 0, 0, 
+      7, 0, 0, 0, 0, 10, 0, 0, 0, 0, 9, 0, 0, 0, 0, 11, 0, 0, 0, 0, 
+      0, 0, 0, 0, 0, 6, 0, 0, 0, 0, 1, 0, 0, 0, 0, 7, 0, 0, 0, 0, 
+      12, 0, 0, 0, 0, 22, -1, 0, 0, 0, 8, 0, 0, -1, 0, 13, 0, 0, 0, 0, 
+      12, 0, 0, 0, 0, 13, 0, 0, 0, 0, 14, 0, 0, 0, 0, 23, -1, 0, 0, 0, 
+      2, 0, 0, 0, -1, 15, 0, 0, 0, 0, 14, 0, 0, 0, 0, 15, 0, 0, 0, 0, 
+      12, 0, 0, 0, 0, 14, 0, 0, 0, 0, 9, 0, 0, -1, 0, 16, 0, 0, 0, 0, 
+      3, 0, 0, 0, -1, 17, 0, 0, 0, 0, 16, 0, 0, 0, 0, 17, 0, 0, 0, 0, 
+      13, 0, 0, 0, 0, 16, 0, 0, 0, 0, 15, 0, 0, 0, 0, 17, 0, 0, 0, 0, 
+      2, 0, 0, 0, 0, 12, 0, 0, 0, 0, 3, 0, 0, 0, 0, 13, 0, 0, 0, 0, 
+      8, 0, 0, 0, 0, 14, 0, 0, 0, 0, 9, 0, 0, 0, 0, 15, 0, 0, 0, 0, 
+      16, 0, -1, 0, 0, 18, 0, 0, 0, 0, 10, 0, 0, -1, 0, 19, 0, 0, 0, 0, 
+      18, 0, 0, 0, 0, 19, 0, 0, 0, 0, 17, 0, -1, 0, 0, 20, 0, 0, 0, 0, 
+      4, 0, 0, 0, -1, 21, 0, 0, 0, 0, 20, 0, 0, 0, 0, 21, 0, 0, 0, 0, 
+      18, 0, 0, 0, 0, 20, 0, 0, 0, 0, 11, 0, 0, -1, 0, 22, 0, 0, 0, 0, 
+      5, 0, 0, 0, -1, 23, 0, 0, 0, 0, 22, 0, 0, 0, 0, 23, 0, 0, 0, 0, 
+      19, 0, 0, 0, 0, 22, 0, 0, 0, 0, 21, 0, 0, 0, 0, 23, 0, 0, 0, 0, 
+      4, 0, 0, 0, 0, 18, 0, 0, 0, 0, 5, 0, 0, 0, 0, 19, 0, 0, 0, 0, 
+      10, 0, 0, 0, 0, 20, 0, 0, 0, 0, 11, 0, 0, 0, 0, 21, 0, 0, 0, 0, 
+      16, 0, 0, 0, 0, 22, 0, 0, 0, 0, 17, 0, 0, 0, 0, 23, 0, 0, 0, 0
+    };
+    return s + side_of_begin(d, type) * 5;
+  }
+
+private:
+  __device__ __host__
+  static int side_of_begin(int d, int type) {
+    static const int type_begin[] = {0, 1, 16, 66, 126};
+    static const int begin[] = {
+      0, 30, 44, 58, 66, 80, 88, 96, 104, 118, 126, 134, 142, 150, 158, 166, 
+      180, 186, 192, 196, 202, 206, 210, 216, 222, 228, 232, 238, 242, 246, 252, 256, 
+      260, 264, 270, 276, 280, 286, 290, 294, 300, 304, 308, 312, 316, 320, 324, 330, 
+      336, 342, 346, 352, 356, 360, 366, 370, 374, 378, 382, 386, 390, 396, 400, 404, 
+      408, 414, 420, 422, 424, 426, 428, 430, 432, 434, 436, 438, 440, 442, 444, 446, 
+      448, 450, 452, 454, 456, 458, 460, 462, 464, 466, 468, 470, 472, 474, 476, 478, 
+      480, 482, 484, 486, 488, 490, 492, 494, 496, 498, 500, 502, 504, 506, 508, 510, 
+      512, 514, 516, 518, 520, 522, 524, 526, 528, 530, 532, 534, 536, 538, 540, 540, 
+      540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 540, 
+      540, 540, 540, 540, 540, 540, 540
+    };
+    return begin[type_begin[d] + type];
+  }
+};
+
+}
+
+#endif
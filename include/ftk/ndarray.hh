@@ -3,12 +3,16 @@
 
 #include <ftk/ftk_config.hh>
 #include <ftk/hypermesh/lattice.hh>
+#include <ftk/ndarray/storage.hh>
+#include <ftk/ndarray/view.hh>
+#include <ftk/ndarray/fixed_ndarray.hh>
 #include <vector>
 #include <array>
 #include <numeric>
 #include <tuple>
 #include <algorithm>
 #include <cstring>
+#include <cstdlib>
 #include <cassert>
 #include <glob.h>
 
@@ -65,13 +69,14 @@ struct ndarray {
   ndarray(const std::vector<size_t> &dims) {reshape(dims);}
   ndarray(const lattice& l) {reshape(l.sizes());}
   ndarray(const T *a, const std::vector<size_t> &shape);
+  explicit ndarray(const ndarray_view<T>& v) {from_view(v);}
 
   std::ostream& print(std::ostream& os) const;
 
   size_t nd() const {return dims.size();}
   size_t dim(size_t i) const {return dims[i];}
   size_t shape(size_t i) const {return dim(i);}
-  size_t nelem() const {return std::accumulate(dims.begin(), dims.end(), 1, std::multiplies<size_t>());}
+  size_t nelem() const {return dims.empty() ? 1 : s.back() * dims.back();}
   bool empty() const  {return p.empty();}
   std::vector<size_t> shape() const {return dims;}
 
@@ -80,6 +85,19 @@ struct ndarray {
   const T* data() const {return p.data();}
   T* data() {return p.data();}
 
+  ndarray_view<T> view() const {return ndarray_view<T>(data(), dims);}
+
+  // fixed-rank accessors to the elements, for N == nd()
+  template <int N> fixed_ndarray<T, N> fixed() {assert(nd() == N); return fixed_ndarray<T, N>(data(), dims.data());}
+  template <int N> fixed_ndarray<const T, N> fixed() const {assert(nd() == N); return fixed_ndarray<const T, N>(data(), dims.data());}
+
+  void from_view(const ndarray_view<T>& v); // copies the viewed elements
+
+  // refers to the viewed elements instead of copying them if they are 
+  // contiguous, e.g. time slices; the elements must outlive the array and 
+  // its copies, which copy them before they are written
+  static ndarray<T> alias(const ndarray_view<T>& v);
+
   void swap(ndarray& x);
 
   void reshape(const std::vector<size_t> &dims_);
@@ -94,6 +112,8 @@ struct ndarray {
   void reshape(size_t n0, size_t n1, size_t n2, size_t n3, size_t n4, size_t n5) {reshape({n0, n1, n2, n3, n4, n5});}
   void reshape(size_t n0, size_t n1, size_t n2, size_t n3, size_t n4, size_t n5, size_t n6) {reshape({n0, n1, n2, n3, n4, n5, n6});}
 
+  // copies; see ndarray_view for slices, time slices and transposes that 
+  // refer to the elements of the array
   ndarray<T> slice(const lattice&) const;
   ndarray<T> slice(const std::vector<size_t>& starts, const std::vector<size_t> &sizes) const;
 
@@ -157,7 +177,7 @@ struct ndarray {
   template <int N, typename F=float> // NxN tensor multilinear interpolation
   T lerpt(F x[]) const; 
 
-  ndarray<T> transpose() const; // only works for 2D arrays
+  ndarray<T> transpose() const; // reverses the dimensions, e.g. of matrices
   ndarray<T> transpose(const std::vector<size_t> order) const; // works for general tensors
 
   template <typename T1>
@@ -172,6 +192,17 @@ struct ndarray {
   void from_binary_file(const std::string& filename);
   void from_binary_file(FILE *fp);
   void from_binary_file_sequence(const std::string& pattern);
+
+  // maps an array of the given shape from the given byte offset of a raw 
+  // binary file instead of reading it; falls back to reading if mapping fails
+  void from_binary_file_mmap(const std::string& filename, const std::vector<size_t>& shape, size_t offset = 0);
+  bool is_mapped() const {return p.mapped();}
+
+  // reads only the given block of an array of the given shape from the 
+  // given byte offset of a raw binary file, e.g. the block of a proc with 
+  // ghost layers; the file is read in runs that are contiguous in the file
+  void from_binary_file(const std::string& filename, const std::vector<size_t>& shape, const lattice& block, size_t offset = 0);
+
   void to_vector(std::vector<T> &out_vector) const;
   void to_binary_file(const std::string& filename);
   void to_binary_file(FILE *fp);
@@ -228,7 +259,7 @@ struct ndarray {
 
 private:
   std::vector<size_t> dims, s;
-  std::vector<T> p;
+  ndarray_storage<T> p;
 
 #if FTK_HAVE_CUDA
   // arrays on GPU
@@ -245,7 +276,7 @@ lattice ndarray<T>::get_lattice() const {
 
 template <typename T>
 void ndarray<T>::to_vector(std::vector<T> &out_vector) const{
-  out_vector = p; 
+  out_vector.assign(p.begin(), p.end()); 
 }
 
 template <typename T>
@@ -303,6 +334,74 @@ void ndarray<T>::from_binary_file(FILE *fp)
   fread(&p[0], sizeof(T), nelem(), fp);
 }
 
+template <typename T>
+void ndarray<T>::from_binary_file_mmap(const std::string& filename, const std::vector<size_t>& shape, size_t offset)
+{
+  const size_t n = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+  if (p.map_file(filename, offset, n)) {
+    reshape(shape); // no-op on the storage, which already has n elements
+    return;
+  }
+
+  reshape(shape);
+  FILE *fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL) {
+    fprintf(stderr, "[FTK] fatal: cannot open %s.\n", filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (fseek(fp, offset, SEEK_SET) != 0 || fread(&p[0], sizeof(T), n, fp) != n) {
+    fprintf(stderr, "[FTK] fatal: cannot read %zu elements at offset %zu of %s.\n", n, offset, filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+  fclose(fp);
+}
+
+template <typename T>
+void ndarray<T>::from_binary_file(const std::string& filename, const std::vector<size_t>& shape, const lattice& block, size_t offset)
+{
+  const size_t n = shape.size();
+  assert(block.nd() == n);
+  reshape(block.sizes());
+  if (nelem() == 0) return;
+
+  // a run spans the dimensions up to the first one that is not covered 
+  // entirely by the block
+  size_t k = 0, run = block.size(0);
+  while (k + 1 < n && block.size(k) == shape[k])
+    run *= block.size(++ k);
+
+  std::vector<size_t> stride(n); // of the file
+  for (size_t i = 0; i < n; i ++)
+    stride[i] = i == 0 ? 1 : stride[i-1] * shape[i-1];
+
+  FILE *fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL) {
+    fprintf(stderr, "[FTK] fatal: cannot open %s.\n", filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<size_t> idx(n, 0); // of the run in the block
+  T *out = &p[0];
+  while (1) {
+    size_t o = 0;
+    for (size_t i = 0; i < n; i ++)
+      o += (block.start(i) + idx[i]) * stride[i];
+    if (fseek(fp, offset + o * sizeof(T), SEEK_SET) != 0 || fread(out, sizeof(T), run, fp) != run) {
+      fprintf(stderr, "[FTK] fatal: cannot read the block of %s, which is truncated.\n", filename.c_str());
+      exit(EXIT_FAILURE);
+    }
+    out += run;
+
+    size_t i = k + 1; // next run
+    for (; i < n; i ++) {
+      if (++ idx[i] < block.size(i)) break;
+      else idx[i] = 0;
+    }
+    if (i >= n) break;
+  }
+  fclose(fp);
+}
+
 template <typename T>
 void ndarray<T>::to_binary_file(const std::string& f)
 {
@@ -739,12 +838,7 @@ inline void ndarray<T>::from_h5(const std::string& filename, const std::string&
 template <typename T>
 inline ndarray<T> ndarray<T>::slice(const lattice& l) const
 {
-  ndarray<T> array(l);
-  for (auto i = 0; i < l.n(); i ++) {
-    auto idx = l.from_integer(i);
-    array[i] = at(idx);
-  }
-  return array;
+  return ndarray<T>(view().slice(l.starts(), l.sizes()));
 }
 
 template <typename T>
@@ -756,14 +850,7 @@ inline ndarray<T> ndarray<T>::slice(const std::vector<size_t>& st, const std::ve
 template <typename T>
 inline ndarray<T> ndarray<T>::slice_time(size_t t) const 
 {
-  ndarray<T> array;
-  std::vector<size_t> mydims(dims);
-  mydims.resize(nd()-1);
-
-  array.reshape(mydims);
-  memcpy(&array[0], &p[t * s[nd()-1]], s[nd()-1] * sizeof(T));
-
-  return array;
+  return ndarray<T>(view().slice_time(t));
 }
 
 template <typename T>
@@ -789,11 +876,31 @@ std::ostream& ndarray<T>::print(std::ostream& os) const
 template <typename T>
 ndarray<T> ndarray<T>::transpose() const 
 {
+  return ndarray<T>(view().transpose());
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::transpose(const std::vector<size_t> order) const
+{
+  return ndarray<T>(view().transpose(order));
+}
+
+template <typename T>
+void ndarray<T>::from_view(const ndarray_view<T>& v)
+{
+  if (v.nd() == 0) {*this = ndarray<T>(); return;}
+  reshape(v.shape());
+  v.copy_to(p.data());
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::alias(const ndarray_view<T>& v)
+{
+  if (v.nd() == 0 || v.empty() || !v.contiguous()) return ndarray<T>(v);
+
   ndarray<T> a;
-  a.reshape(dim(1), dim(0));
-  for (auto i = 0; i < dim(0); i ++) 
-    for (auto j = 0; j < dim(1); j ++)
-      a(j, i) = at(i, j);
+  a.p.alias(v.data(), v.nelem());
+  a.reshape(v.shape()); // keeps the aliased elements
   return a;
 }
 
@@ -3,10 +3,183 @@
 
 #include <cmath>
 #include <string>
+#include <vector>
+#include <cassert>
+#include <algorithm>
 #include <ftk/ndarray.hh>
 
 namespace ftk {
 
+// Convolves (correlates) the given axis of data with a 1D kernel, i.e. 
+// conv2D/conv3D with a kernel of size 1 along the other axes and without 
+// the normalization; the size of the axis becomes n + 2*padding - ksize + 1.
+// For every tap, the range of outputs with valid inputs is computed 
+// upfront, so that the inner loops run over contiguous elements without 
+// bounds checks.
+template <typename T>
+void conv1D_axis(const ndarray<T> &data, const std::vector<T> &kernel, 
+                 size_t axis, size_t padding, ndarray<T> &res)
+{
+  const long n = data.dim(axis), 
+             ksize = kernel.size(),
+             p = padding,
+             n_r = n + 2 * p - ksize + 1;
+  size_t inner = 1, outer = 1; // elements before and after the axis
+  for (size_t i = 0; i < axis; i ++) inner *= data.dim(i);
+  for (size_t i = axis + 1; i < data.nd(); i ++) outer *= data.dim(i);
+
+  std::vector<size_t> dims = data.shape();
+  dims[axis] = std::max(n_r, 0L);
+  res.reshape(dims, T(0));
+  if (n_r <= 0) return;
+
+  // blocks of lines along the axis, outer * nblocks in total
+  const size_t block = inner == 1 ? 1 : std::min(inner, size_t(4096)), 
+               nblocks = (inner + block - 1) / block;
+
+#pragma omp parallel for
+  for (long b = 0; b < static_cast<long>(outer * nblocks); b ++) {
+    const size_t o = b / nblocks, 
+                 i0 = (b % nblocks) * block, 
+                 i1 = std::min(i0 + block, inner);
+    const T *in = data.data() + o * n * inner;
+    T *out = res.data() + o * n_r * inner;
+
+    for (long k = 0; k < ksize; k ++) {
+      const long x0 = std::max(0L, p - k), 
+                 x1 = std::min(n_r, n + p - k);
+      const T w = kernel[k];
+      if (x0 >= x1) continue;
+
+      if (i1 - i0 == inner) { // whole lines are contiguous
+        T *po = out + x0 * inner;
+        const T *pi = in + (x0 - p + k) * inner;
+        const size_t len = (x1 - x0) * inner;
+#pragma omp simd
+        for (size_t j = 0; j < len; j ++)
+          po[j] += w * pi[j];
+      } else {
+        for (long x = x0; x < x1; x ++) {
+          T *po = out + x * inner;
+          const T *pi = in + (x - p + k) * inner;
+#pragma omp simd
+          for (size_t j = i0; j < i1; j ++)
+            po[j] += w * pi[j];
+        }
+      }
+    }
+  }
+}
+
+// normalized 1D gaussian kernel; the 2D and 3D kernels are outer products
+template <typename T>
+std::vector<T> gaussian_kernel1D(T sigma, size_t ksize)
+{
+  std::vector<T> kernel(ksize);
+  const double center = static_cast<double>(ksize - 1) * .5, 
+               s = 2. * sigma * sigma;
+  double sum = 0.;
+  for (size_t i = 0; i < ksize; i ++) {
+    const double x = static_cast<double>(i) - center;
+    kernel[i] = std::exp(-x * x / s);
+    sum += kernel[i];
+  }
+  for (size_t i = 0; i < ksize; i ++)
+    kernel[i] /= sum;
+  return kernel;
+}
+
+// Separable gaussian convolution along the first ksizes.size() axes, with 
+// one 1D pass per axis; the result is the same as conv2D_gaussian or 
+// conv3D_gaussian up to rounding, including the division by the number of 
+// taps.  res may be the same array as data.
+template <typename T>
+void conv_gaussian_separable(const ndarray<T> &data, ndarray<T> &res, T sigma, 
+                             const std::vector<size_t> &ksizes, size_t padding = 0)
+{
+  size_t ntaps = 1;
+  for (const auto k : ksizes) ntaps *= k;
+
+  ndarray<T> buf[2];
+  const ndarray<T> *in = &data;
+  for (size_t axis = 0; axis < ksizes.size(); axis ++) {
+    auto kernel = gaussian_kernel1D(sigma, ksizes[axis]);
+    if (axis == ksizes.size() - 1) // fold the normalization into the last pass
+      for (auto &w : kernel) w /= ntaps;
+
+    ndarray<T> &out = buf[axis % 2];
+    conv1D_axis(*in, kernel, axis, padding, out);
+    in = &out;
+  }
+  if (ksizes.empty()) res = data;
+  else res.swap(buf[(ksizes.size() - 1) % 2]);
+}
+
+// views are read in place if they are contiguous and copied otherwise
+template <typename T>
+void conv_gaussian_separable(const ndarray_view<T> &data, ndarray<T> &res, T sigma, 
+                             const std::vector<size_t> &ksizes, size_t padding = 0)
+{
+  if (ksizes.empty()) res.from_view(data); // not an alias of the view
+  else conv_gaussian_separable(ndarray<T>::alias(data), res, sigma, ksizes, padding);
+}
+
+// Recursive (IIR) approximation of the gaussian filter [Young and van 
+// Vliet 1995] along the first nd axes (all axes if nd < 0), in place.  The 
+// cost does not depend on sigma, which must be at least 0.5; borders are 
+// extended with the values at the edges, and the output has the size of 
+// the input.
+template <typename T>
+void gaussian_filter_recursive(ndarray<T> &data, T sigma, int nd = -1)
+{
+  assert(sigma >= 0.5);
+  const double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 
+                                : 3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * sigma);
+  const double q2 = q * q, q3 = q2 * q;
+  const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3, 
+               b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0,
+               b2 = -(1.4281 * q2 + 1.26661 * q3) / b0,
+               b3 = 0.422205 * q3 / b0;
+  const T B = 1 - (b1 + b2 + b3);
+
+  if (nd < 0) nd = data.nd();
+  for (int axis = 0; axis < nd; axis ++) {
+    const long n = data.dim(axis);
+    size_t inner = 1, outer = 1;
+    for (int i = 0; i < axis; i ++) inner *= data.dim(i);
+    for (size_t i = axis + 1; i < data.nd(); i ++) outer *= data.dim(i);
+    if (n == 0 || inner * outer == 0) continue;
+
+    // lines along the axis are filtered together, inner of them at a time;
+    // w1, w2, w3 are the previous outputs of the lines
+#pragma omp parallel for
+    for (long o = 0; o < static_cast<long>(outer); o ++) {
+      T *v = data.data() + o * n * inner;
+      std::vector<T> w1(v, v + inner), w2(w1), w3(w1); // causal
+      for (long x = 0; x < n; x ++) {
+        T *px = v + x * inner;
+#pragma omp simd
+        for (size_t i = 0; i < inner; i ++) {
+          const T w = B * px[i] + b1 * w1[i] + b2 * w2[i] + b3 * w3[i];
+          w3[i] = w2[i]; w2[i] = w1[i]; w1[i] = w;
+          px[i] = w;
+        }
+      }
+      w1.assign(v + (n-1) * inner, v + n * inner); // anti-causal
+      w2 = w1; w3 = w1;
+      for (long x = n - 1; x >= 0; x --) {
+        T *px = v + x * inner;
+#pragma omp simd
+        for (size_t i = 0; i < inner; i ++) {
+          const T w = B * px[i] + b1 * w1[i] + b2 * w2[i] + b3 * w3[i];
+          w3[i] = w2[i]; w2[i] = w1[i]; w1[i] = w;
+          px[i] = w;
+        }
+      }
+    }
+  }
+}
+
 // 2D convolutions
 template <typename T>
 ndarray<T> conv2D(const ndarray<T> &data, const ndarray<T> &kernel,
@@ -79,12 +252,8 @@ ndarray<T> conv2D_gaussian(const ndarray<T> &data, T sigma,
                            size_t ksizex = 5, size_t ksizey = 5,
                            size_t padding = 0)
 {
-  // make kernel
-  const auto kernel = gaussian_kernel2D(sigma, ksizex, ksizey);
-
-  // convolution
-  auto res = conv2D(data, kernel, padding);
-
+  ndarray<T> res;
+  conv_gaussian_separable(data, res, sigma, {ksizex, ksizey}, padding);
   return res;
 }
 
@@ -176,12 +345,8 @@ ndarray<T> conv3D_gaussian(
     size_t ksizex = 5, size_t ksizey = 5, size_t ksizez = 5,
     size_t padding = 0)
 {
-  // make kernel
-  const auto kernel = gaussian_kernel3D(sigma, ksizex, ksizey, ksizez);
-
-  // convolution
-  auto res = conv3D(data, kernel, padding);
-
+  ndarray<T> res;
+  conv_gaussian_separable(data, res, sigma, {ksizex, ksizey, ksizez}, padding);
   return res;
 }
 
@@ -0,0 +1,67 @@
+#ifndef _FTK_NDARRAY_FIXED_NDARRAY_HH
+#define _FTK_NDARRAY_FIXED_NDARRAY_HH
+
+#include <ftk/ftk_config.hh>
+#include <array>
+#include <cstddef>
+
+namespace ftk {
+
+// Fixed-rank accessor to the elements of an ndarray, obtained with
+// ndarray::fixed<N>() without copying the elements.  The shape and the
+// strides are kept in std::arrays and the number of elements is cached,
+// so that indexing in hot loops does not read them from the heap.  The
+// elements must outlive the accessor; T is const for const arrays.
+template <typename T, int N>
+struct fixed_ndarray {
+  fixed_ndarray() {}
+  fixed_ndarray(T *p, const size_t dims[]);
+
+  static constexpr int nd() {return N;}
+  size_t dim(int i) const {return dims[i];}
+  size_t shape(int i) const {return dim(i);}
+  size_t nelem() const {return n;}
+  bool empty() const {return n == 0;}
+
+  T* data() const {return p;}
+
+  size_t index(const std::array<size_t, N>& idx) const;
+
+  T& operator[](size_t i) const {return p[i];}
+  T& operator()(size_t i0) const {static_assert(N == 1, "rank mismatch"); return p[i0];}
+  T& operator()(size_t i0, size_t i1) const {static_assert(N == 2, "rank mismatch"); return p[i0+i1*s[1]];}
+  T& operator()(size_t i0, size_t i1, size_t i2) const {static_assert(N == 3, "rank mismatch"); return p[i0+i1*s[1]+i2*s[2]];}
+  T& operator()(size_t i0, size_t i1, size_t i2, size_t i3) const {static_assert(N == 4, "rank mismatch"); return p[i0+i1*s[1]+i2*s[2]+i3*s[3]];}
+  T& operator()(size_t i0, size_t i1, size_t i2, size_t i3, size_t i4) const {static_assert(N == 5, "rank mismatch"); return p[i0+i1*s[1]+i2*s[2]+i3*s[3]+i4*s[4]];}
+
+private:
+  T *p = NULL;
+  std::array<size_t, N> dims, s; // s[0] is always 1
+  size_t n = 0;
+};
+
+/////
+template <typename T, int N>
+fixed_ndarray<T, N>::fixed_ndarray(T *p_, const size_t dims_[])
+  : p(p_)
+{
+  n = 1;
+  for (int i = 0; i < N; i ++) {
+    dims[i] = dims_[i];
+    s[i] = n;
+    n *= dims[i];
+  }
+}
+
+template <typename T, int N>
+size_t fixed_ndarray<T, N>::index(const std::array<size_t, N>& idx) const
+{
+  size_t i = idx[0];
+  for (int j = 1; j < N; j ++)
+    i += idx[j] * s[j];
+  return i;
+}
+
+}
+
+#endif
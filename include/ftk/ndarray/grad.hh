@@ -3,25 +3,66 @@
 
 #include <ftk/ndarray.hh>
 #include <ftk/hypermesh/regular_simplex_mesh.hh>
+#include <algorithm>
+#include <vector>
 
 namespace ftk {
 
-// derive 2D gradients for 2D scalar field
+// Zeroes the elements of a field within w vertices of the border, where 
+// the first nc dimensions are components, e.g. the border of derivatives 
+// that are only computed in the interior and written to reused buffers.
 template <typename T>
-ndarray<T> gradient2D(const ndarray<T>& scalar)
+void zero_border(ndarray<T>& a, int nc, int w)
+{
+  size_t ncomp = 1, nrows = 1;
+  for (int i = 0; i < nc; i ++) ncomp *= a.dim(i);
+  for (size_t i = nc + 1; i < a.nd(); i ++) nrows *= a.dim(i);
+  const size_t DW = a.dim(nc), row = ncomp * DW, 
+               wx = std::min(size_t(w), DW);
+  
+  for (size_t r = 0; r < nrows; r ++) {
+    bool border = false; // if the row is within w of the border
+    for (size_t i = nc + 1, q = r; i < a.nd(); q /= a.dim(i), i ++) {
+      const size_t x = q % a.dim(i);
+      if (x < size_t(w) || x + w >= a.dim(i)) border = true;
+    }
+
+    T *p = a.data() + r * row;
+    if (border) std::fill(p, p + row, T(0));
+    else {
+      std::fill(p, p + wx * ncomp, T(0));
+      std::fill(p + (DW - wx) * ncomp, p + row, T(0));
+    }
+  }
+}
+
+// derive 2D gradients for 2D scalar field; grad is reused if it has the 
+// same size.  The 2D derivatives are scaled by the number of cells along 
+// each dimension; if the array is a block of a larger domain, gw and gh 
+// are the sizes of the domain.
+template <typename T>
+void gradient2D(const ndarray<T>& scalar, ndarray<T>& grad, int gw = 0, int gh = 0)
 {
   const int DW = scalar.dim(0), DH = scalar.dim(1);
-  ndarray<T> grad;
+  const int SW = gw ? gw : DW, SH = gh ? gh : DH;
   grad.reshape(2, DW, DH); 
+  zero_border(grad, 1, 1);
 
 #pragma omp parallel for collapse(2)
   for (int j = 1; j < DH-1; j ++) {
     for (int i = 1; i < DW-1; i ++) {
-      auto dfdx = grad(0, i, j) = 0.5 * (scalar(i+1, j) - scalar(i-1, j)) * (DW-1);
-      auto dfdy = grad(1, i, j) = 0.5 * (scalar(i, j+1) - scalar(i, j-1)) * (DH-1);
+      auto dfdx = grad(0, i, j) = 0.5 * (scalar(i+1, j) - scalar(i-1, j)) * (SW-1);
+      auto dfdy = grad(1, i, j) = 0.5 * (scalar(i, j+1) - scalar(i, j-1)) * (SH-1);
       // fprintf(stderr, "s=%f, grad=%f, %f\n", scalar(i, j), dfdx, dfdy);
     }
   }
+}
+
+template <typename T>
+ndarray<T> gradient2D(const ndarray<T>& scalar)
+{
+  ndarray<T> grad;
+  gradient2D(scalar, grad);
   return grad;
 }
 
@@ -45,30 +86,57 @@ ndarray<T> gradient2Dt(const ndarray<T>& scalar)
   return grad;
 }
 
-// derive gradients for 2D vector field
+// derive gradients for 2D vector field; grad is reused if it has the 
+// same size, and gw and gh are the same as in gradient2D
 template <typename T>
-ndarray<T> jacobian2D(const ndarray<T>& vec)
+void jacobian2D(const ndarray<T>& vec, ndarray<T>& grad, int gw = 0, int gh = 0)
 {
   const int DW = vec.dim(1), DH = vec.dim(2);
-  ndarray<T> grad;
+  const int SW = gw ? gw : DW, SH = gh ? gh : DH;
   grad.reshape(2, 2, DW, DH);
+  zero_border(grad, 2, 2);
 
 #pragma omp parallel for collapse(2)
   for (int j = 2; j < DH-2; j ++) {
     for (int i = 2; i < DW-2; i ++) {
       const T H00 = grad(0, 0, i, j) = // du/dx 
-        0.5 * (vec(0, i+1, j) - vec(0, i-1, j)) * (DW-1); 
+        0.5 * (vec(0, i+1, j) - vec(0, i-1, j)) * (SW-1); 
       const T H01 = grad(0, 1, i, j) = // du/dy
-        0.5 * (vec(0, i, j+1) - vec(0, i, j-1)) * (DH-1);
+        0.5 * (vec(0, i, j+1) - vec(0, i, j-1)) * (SH-1);
       const T H10 = grad(1, 0, i, j) = // dv/dx
-        0.5 * (vec(1, i+1, j) - vec(1, i-1, j)) * (DW-1);
+        0.5 * (vec(1, i+1, j) - vec(1, i-1, j)) * (SW-1);
       const T H11 = grad(1, 1, i, j) = // dv.dy
-        0.5 * (vec(1, i, j+1) - vec(1, i, j-1)) * (DH-1);
+        0.5 * (vec(1, i, j+1) - vec(1, i, j-1)) * (SH-1);
     }
   }
+}
+
+template <typename T>
+ndarray<T> jacobian2D(const ndarray<T>& vec)
+{
+  ndarray<T> grad;
+  jacobian2D(vec, grad);
   return grad;
 }
 
+// Jacobian of a 2D vector field at vertex (i, j), the same as 
+// jacobian2D(vec)(*, *, i, j) but without deriving the whole field
+template <typename T>
+void jacobian2D(const ndarray<T>& vec, int i, int j, T J[2][2], int gw = 0, int gh = 0)
+{
+  const int DW = vec.dim(1), DH = vec.dim(2);
+  const int SW = gw ? gw : DW, SH = gh ? gh : DH;
+  if (i < 2 || i >= DW-2 || j < 2 || j >= DH-2) {
+    J[0][0] = J[0][1] = J[1][0] = J[1][1] = T(0);
+    return;
+  }
+
+  J[0][0] = 0.5 * (vec(0, i+1, j) - vec(0, i-1, j)) * (SW-1); // du/dx
+  J[0][1] = 0.5 * (vec(0, i, j+1) - vec(0, i, j-1)) * (SH-1); // du/dy
+  J[1][0] = 0.5 * (vec(1, i+1, j) - vec(1, i-1, j)) * (SW-1); // dv/dx
+  J[1][1] = 0.5 * (vec(1, i, j+1) - vec(1, i, j-1)) * (SH-1); // dv/dy
+}
+
 // Derive Jacobians for piecewise linear vector field on regular grid.
 // The jacobian field is piecewise constant
 template <typename T>
@@ -110,13 +178,14 @@ ndarray<T> jacobian2Dt(const ndarray<T>& vec)
   return grad;
 }
 
-// derive gradients for 3D scalar field
+// derive gradients for 3D scalar field; grad is reused if it has the 
+// same size
 template <typename T>
-ndarray<T> gradient3D(const ndarray<T>& scalar)
+void gradient3D(const ndarray<T>& scalar, ndarray<T>& grad)
 {
   const int DW = scalar.dim(0), DH = scalar.dim(1), DD = scalar.dim(2);
-  ndarray<T> grad;
   grad.reshape(3, DW, DH, DD);
+  zero_border(grad, 1, 1);
 
 #pragma omp parallel for collapse(3)
   for (int k = 1; k < DD-1; k ++) {
@@ -128,7 +197,13 @@ ndarray<T> gradient3D(const ndarray<T>& scalar)
       }
     }
   }
+}
 
+template <typename T>
+ndarray<T> gradient3D(const ndarray<T>& scalar)
+{
+  ndarray<T> grad;
+  gradient3D(scalar, grad);
   return grad;
 }
 
@@ -155,13 +230,14 @@ ndarray<T> gradient3Dt(const ndarray<T>& scalar)
   return grad;
 }
 
-// derivate gradients (jacobians) for 3D vector field
+// derivate gradients (jacobians) for 3D vector field; J is reused if it 
+// has the same size
 template <typename T>
-ndarray<T> jacobian3D(const ndarray<T>& V)
+void jacobian3D(const ndarray<T>& V, ndarray<T>& J)
 {
   const int DW = V.dim(1), DH = V.dim(2), DD = V.dim(3);
-  ndarray<T> J;
   J.reshape(3, 3, DW, DH, DD);
+  zero_border(J, 2, 2);
 
 #pragma omp parallel for collapse(3)
   for (int k = 2; k < DD-2; k ++) {
@@ -190,10 +266,36 @@ ndarray<T> jacobian3D(const ndarray<T>& V)
       }
     }
   }
+}
 
+template <typename T>
+ndarray<T> jacobian3D(const ndarray<T>& V)
+{
+  ndarray<T> J;
+  jacobian3D(V, J);
   return J;
 }
 
+// Jacobian of a 3D vector field at vertex (i, j, k), the same as 
+// jacobian3D(V)(*, *, i, j, k) but without deriving the whole field
+template <typename T>
+void jacobian3D(const ndarray<T>& V, int i, int j, int k, T J[3][3])
+{
+  const int DW = V.dim(1), DH = V.dim(2), DD = V.dim(3);
+  if (i < 2 || i >= DW-2 || j < 2 || j >= DH-2 || k < 2 || k >= DD-2) {
+    for (int a = 0; a < 3; a ++)
+      for (int b = 0; b < 3; b ++)
+        J[a][b] = T(0);
+    return;
+  }
+
+  for (int a = 0; a < 3; a ++) {
+    J[a][0] = 0.5 * (V(a, i+1, j, k) - V(a, i-1, j, k));
+    J[a][1] = 0.5 * (V(a, i, j+1, k) - V(a, i, j-1, k));
+    J[a][2] = 0.5 * (V(a, i, j, k+1) - V(a, i, j, k-1));
+  }
+}
+
 // derive gradients (jacobians) for 3D time varying vector field
 template <typename T>
 ndarray<T> jacobian3Dt(const ndarray<T>& V)
@@ -235,6 +337,170 @@ ndarray<T> jacobian3Dt(const ndarray<T>& V)
   return J;
 }
 
+// Gradient and Jacobian of a 2D scalar field in a single sweep, the same as 
+// gradient2D(scalar) and jacobian2D(gradient2D(scalar)).  Threads process 
+// tiles of rows, computing the Jacobian of a row right after the gradient 
+// of the next row while both are in cache; the gradient rows next to a 
+// tile are recomputed instead of shared.  grad and J are written in place 
+// (including their zero borders) and only reallocated if their sizes 
+// change, so that the buffers can be reused across timesteps; gw and gh 
+// are the same as in gradient2D.
+template <typename T>
+void gradient_jacobian2D(const ndarray<T>& scalar, ndarray<T>& grad, ndarray<T>& J, 
+    int tile = 16, int gw = 0, int gh = 0)
+{
+  const int DW = scalar.dim(0), DH = scalar.dim(1);
+  const int SW = gw ? gw : DW, SH = gh ? gh : DH;
+  grad.reshape(2, DW, DH);
+  J.reshape(2, 2, DW, DH);
+
+  const T *f = scalar.data();
+  T *g = grad.data(), *h = J.data();
+
+  auto gradient_row = [&](int j, T *out) {
+    std::fill(out, out + 2*DW, T(0));
+    if (j < 1 || j >= DH-1) return;
+    const T *r = f + j*DW, *rd = r - DW, *ru = r + DW;
+#pragma omp simd
+    for (int i = 1; i < DW-1; i ++) {
+      out[2*i]   = 0.5 * (r[i+1] - r[i-1]) * (SW-1);
+      out[2*i+1] = 0.5 * (ru[i] - rd[i]) * (SH-1);
+    }
+  };
+
+  // J(a, b, i, j) is at 4*i + a + 2*b of the row
+  auto jacobian_row = [&](int j, const T *gd, const T *g0, const T *gu, T *out) {
+    std::fill(out, out + 4*DW, T(0));
+    if (j < 2 || j >= DH-2) return;
+#pragma omp simd
+    for (int i = 2; i < DW-2; i ++) {
+      out[4*i]   = 0.5 * (g0[2*i+2] - g0[2*i-2]) * (SW-1); // du/dx
+      out[4*i+2] = 0.5 * (gu[2*i] - gd[2*i]) * (SH-1); // du/dy
+      out[4*i+1] = 0.5 * (g0[2*i+3] - g0[2*i-1]) * (SW-1); // dv/dx
+      out[4*i+3] = 0.5 * (gu[2*i+1] - gd[2*i+1]) * (SH-1); // dv/dy
+    }
+  };
+
+  const int ntiles = (DH + tile - 1) / tile;
+#pragma omp parallel for
+  for (int t = 0; t < ntiles; t ++) {
+    const int j0 = t * tile, j1 = std::min(j0 + tile, DH);
+    std::vector<T> below(2*DW), above(2*DW); // gradient rows j0-1 and j1
+    if (j0 > 0) gradient_row(j0-1, below.data());
+    if (j1 < DH) gradient_row(j1, above.data());
+
+    auto row = [&](int j) -> const T* {
+      if (j < j0) return below.data();
+      else if (j >= j1) return above.data();
+      else return g + 2*DW*j;
+    };
+
+    for (int j = j0; j < j1; j ++) {
+      gradient_row(j, g + 2*DW*j);
+      if (j > j0) jacobian_row(j-1, row(j-2), row(j-1), row(j), h + 4*DW*(j-1));
+    }
+    jacobian_row(j1-1, row(j1-2), row(j1-1), row(j1), h + 4*DW*(j1-1));
+  }
+}
+
+// Gradient and Jacobian of a 3D scalar field in a single sweep, the same as 
+// gradient3D(scalar) and jacobian3D(gradient3D(scalar)); see 
+// gradient_jacobian2D.  Threads process tiles of slices along z.
+template <typename T>
+void gradient_jacobian3D(const ndarray<T>& scalar, ndarray<T>& grad, ndarray<T>& J, int tile = 4)
+{
+  const int DW = scalar.dim(0), DH = scalar.dim(1), DD = scalar.dim(2);
+  const size_t ns = size_t(DW) * DH; // vertices per slice
+  grad.reshape(3, DW, DH, DD);
+  J.reshape(3, 3, DW, DH, DD);
+
+  const T *f = scalar.data();
+  T *g = grad.data(), *h = J.data();
+
+  auto gradient_slice = [&](int k, T *out) {
+    std::fill(out, out + 3*ns, T(0));
+    if (k < 1 || k >= DD-1) return;
+    for (int j = 1; j < DH-1; j ++) {
+      const T *r = f + k*ns + j*DW, 
+              *ry0 = r - DW, *ry1 = r + DW, *rz0 = r - ns, *rz1 = r + ns;
+      T *o = out + 3*DW*j;
+#pragma omp simd
+      for (int i = 1; i < DW-1; i ++) {
+        o[3*i]   = 0.5 * (r[i+1] - r[i-1]);
+        o[3*i+1] = 0.5 * (ry1[i] - ry0[i]);
+        o[3*i+2] = 0.5 * (rz1[i] - rz0[i]);
+      }
+    }
+  };
+
+  // J(a, b, i, j, k) is at 9*(i + DW*j) + a + 3*b of the slice
+  auto jacobian_slice = [&](int k, const T *gd, const T *g0, const T *gu, T *out) {
+    std::fill(out, out + 9*ns, T(0));
+    if (k < 2 || k >= DD-2) return;
+    for (int j = 2; j < DH-2; j ++) {
+      const T *r = g0 + 3*DW*j, *ry0 = r - 3*DW, *ry1 = r + 3*DW, 
+              *rz0 = gd + 3*DW*j, *rz1 = gu + 3*DW*j;
+      T *o = out + 9*DW*j;
+#pragma omp simd
+      for (int i = 2; i < DW-2; i ++) {
+        for (int a = 0; a < 3; a ++) {
+          o[9*i+a]   = 0.5 * (r[3*i+3+a] - r[3*i-3+a]);
+          o[9*i+a+3] = 0.5 * (ry1[3*i+a] - ry0[3*i+a]);
+          o[9*i+a+6] = 0.5 * (rz1[3*i+a] - rz0[3*i+a]);
+        }
+      }
+    }
+  };
+
+  const int ntiles = (DD + tile - 1) / tile;
+#pragma omp parallel for
+  for (int t = 0; t < ntiles; t ++) {
+    const int k0 = t * tile, k1 = std::min(k0 + tile, DD);
+    std::vector<T> below(3*ns), above(3*ns); // gradient slices k0-1 and k1
+    if (k0 > 0) gradient_slice(k0-1, below.data());
+    if (k1 < DD) gradient_slice(k1, above.data());
+
+    auto slice = [&](int k) -> const T* {
+      if (k < k0) return below.data();
+      else if (k >= k1) return above.data();
+      else return g + 3*ns*k;
+    };
+
+    for (int k = k0; k < k1; k ++) {
+      gradient_slice(k, g + 3*ns*k);
+      if (k > k0) jacobian_slice(k-1, slice(k-2), slice(k-1), slice(k), h + 9*ns*(k-1));
+    }
+    jacobian_slice(k1-1, slice(k1-2), slice(k1-1), slice(k1), h + 9*ns*(k1-1));
+  }
+}
+
+// Views, e.g. time slices of spacetime arrays, are read in place if they 
+// are contiguous and copied otherwise.
+template <typename T>
+ndarray<T> gradient2D(const ndarray_view<T>& scalar) {return gradient2D(ndarray<T>::alias(scalar));}
+
+template <typename T>
+ndarray<T> jacobian2D(const ndarray_view<T>& vec) {return jacobian2D(ndarray<T>::alias(vec));}
+
+template <typename T>
+ndarray<T> gradient3D(const ndarray_view<T>& scalar) {return gradient3D(ndarray<T>::alias(scalar));}
+
+template <typename T>
+ndarray<T> jacobian3D(const ndarray_view<T>& V) {return jacobian3D(ndarray<T>::alias(V));}
+
+template <typename T>
+void gradient_jacobian2D(const ndarray_view<T>& scalar, ndarray<T>& grad, ndarray<T>& J, 
+    int tile = 16, int gw = 0, int gh = 0)
+{
+  gradient_jacobian2D(ndarray<T>::alias(scalar), grad, J, tile, gw, gh);
+}
+
+template <typename T>
+void gradient_jacobian3D(const ndarray_view<T>& scalar, ndarray<T>& grad, ndarray<T>& J, int tile = 4)
+{
+  gradient_jacobian3D(ndarray<T>::alias(scalar), grad, J, tile);
+}
+
 }
 
 #endif
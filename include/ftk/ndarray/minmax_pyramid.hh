@@ -0,0 +1,182 @@
+#ifndef _FTK_NDARRAY_MINMAX_PYRAMID_HH
+#define _FTK_NDARRAY_MINMAX_PYRAMID_HH
+
+#include <ftk/ndarray.hh>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace ftk {
+
+// Min/max pyramid of a vector field of shape (nc, n_1, ..., n_nd), i.e.
+// with the components in the first dimension.  Level 0 bounds every
+// component over bricks of brick_size^nd cells, where a cell spans the
+// vertices [x, x+1] in every dimension; each level above merges 2^nd
+// blocks of the level below, up to a single block.  A block whose bounds
+// are strictly positive or strictly negative in any component cannot
+// contain a zero of the (piecewise linear) field.  NaNs widen the bounds
+// to infinity.
+template <typename T>
+struct minmax_pyramid {
+  enum {brick_size = 4};
+
+  void build(const ndarray<T>& V);
+  void clear() {levels.clear(); cells.clear();}
+  bool empty() const {return levels.empty();}
+
+  int nd() const {return cells.size();}
+  int nc() const {return ncomponents;}
+  int nlevels() const {return levels.size();}
+
+  size_t ncells(int i) const {return cells[i];}
+  size_t nblocks(int k, int i) const {return levels[k].n[i];}
+  size_t block_size(int k) const {return size_t(brick_size) << k;} // in cells
+
+  size_t block_index(int k, const size_t b[]) const;
+
+  // bounds of the nc components of the block b of level k
+  const T* lower(int k, size_t b) const {return levels[k].lo.data() + b * ncomponents;}
+  const T* upper(int k, size_t b) const {return levels[k].hi.data() + b * ncomponents;}
+
+private:
+  struct level_t {
+    std::vector<size_t> n; // number of blocks in each dimension
+    std::vector<T> lo, hi;
+  };
+  std::vector<level_t> levels;
+  std::vector<size_t> cells;
+  int ncomponents = 0;
+};
+
+/////
+template <typename T>
+size_t minmax_pyramid<T>::block_index(int k, const size_t b[]) const
+{
+  size_t idx = 0;
+  for (int i = nd() - 1; i >= 0; i --)
+    idx = idx * levels[k].n[i] + b[i];
+  return idx;
+}
+
+template <typename T>
+void minmax_pyramid<T>::build(const ndarray<T>& V)
+{
+  clear();
+  if (V.nd() < 2) return;
+
+  const int nd = V.nd() - 1, nc = V.dim(0);
+  ncomponents = nc;
+  for (int i = 0; i < nd; i ++) {
+    if (V.dim(i+1) < 2) {clear(); return;}
+    cells.push_back(V.dim(i+1) - 1);
+  }
+
+  const T inf = std::numeric_limits<T>::infinity();
+  auto nbricks = [&](int i) {return (cells[i] + brick_size - 1) / brick_size;};
+
+  level_t l0;
+  size_t nb = 1;
+  for (int i = 0; i < nd; i ++) {
+    l0.n.push_back(nbricks(i));
+    nb *= l0.n[i];
+  }
+  l0.lo.assign(nb * nc, inf);
+  l0.hi.assign(nb * nc, -inf);
+  levels.push_back(l0);
+  level_t &L = levels[0];
+
+  // rows of vertices along the first dimension; a vertex on a brick
+  // boundary belongs to the bricks on both sides
+  std::vector<size_t> x(nd, 0), b0(nd), b1(nd), b(nd);
+  std::vector<T> rlo(nc), rhi(nc);
+  while (1) {
+    for (int i = 1; i < nd; i ++) {
+      b1[i] = std::min(x[i] / brick_size, l0.n[i] - 1);
+      b0[i] = (x[i] % brick_size == 0 && x[i] > 0) ? x[i] / brick_size - 1 : b1[i];
+    }
+
+    size_t offset = 0; // of the first vertex of the row
+    for (int i = nd - 1; i >= 1; i --)
+      offset = offset * V.dim(i+1) + x[i];
+    const T *row = V.data() + offset * V.dim(1) * nc;
+
+    for (size_t k = 0; k < L.n[0]; k ++) {
+      const size_t v0 = k * brick_size,
+                   v1 = std::min(v0 + brick_size, cells[0]); // inclusive
+      std::fill(rlo.begin(), rlo.end(), inf);
+      std::fill(rhi.begin(), rhi.end(), -inf);
+      for (size_t v = v0; v <= v1; v ++)
+        for (int c = 0; c < nc; c ++) {
+          const T f = row[v * nc + c];
+          if (std::isnan(f)) {rlo[c] = -inf; rhi[c] = inf;}
+          else {
+            rlo[c] = std::min(rlo[c], f);
+            rhi[c] = std::max(rhi[c], f);
+          }
+        }
+
+      // merge the row into every brick that contains it
+      b[0] = k;
+      for (int i = 1; i < nd; i ++) b[i] = b0[i];
+      while (1) {
+        const size_t idx = block_index(0, b.data()) * nc;
+        for (int c = 0; c < nc; c ++) {
+          L.lo[idx + c] = std::min(L.lo[idx + c], rlo[c]);
+          L.hi[idx + c] = std::max(L.hi[idx + c], rhi[c]);
+        }
+        int i = 1;
+        for (; i < nd; i ++) {
+          if (++ b[i] <= b1[i]) break;
+          else b[i] = b0[i];
+        }
+        if (i >= nd) break;
+      }
+    }
+
+    int i = 1; // next row
+    for (; i < nd; i ++) {
+      if (++ x[i] <= cells[i]) break;
+      else x[i] = 0;
+    }
+    if (i >= nd) break;
+  }
+
+  // coarser levels
+  while (1) {
+    const level_t &fine = levels.back();
+    bool top = true;
+    for (int i = 0; i < nd; i ++)
+      if (fine.n[i] > 1) top = false;
+    if (top) break;
+
+    level_t coarse;
+    nb = 1;
+    for (int i = 0; i < nd; i ++) {
+      coarse.n.push_back((fine.n[i] + 1) / 2);
+      nb *= coarse.n[i];
+    }
+    coarse.lo.assign(nb * nc, inf);
+    coarse.hi.assign(nb * nc, -inf);
+
+    std::fill(b.begin(), b.end(), 0);
+    for (size_t j = 0; j < fine.lo.size() / nc; j ++) { // b is the multi-index of j
+      size_t idx = 0;
+      for (int i = nd - 1; i >= 0; i --)
+        idx = idx * coarse.n[i] + b[i] / 2;
+      for (int c = 0; c < nc; c ++) {
+        coarse.lo[idx * nc + c] = std::min(coarse.lo[idx * nc + c], fine.lo[j * nc + c]);
+        coarse.hi[idx * nc + c] = std::max(coarse.hi[idx * nc + c], fine.hi[j * nc + c]);
+      }
+      for (int i = 0; i < nd; i ++) {
+        if (++ b[i] < fine.n[i]) break;
+        else b[i] = 0;
+      }
+    }
+    levels.push_back(coarse);
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef _FTK_NDARRAY_STORAGE_HH
+#define _FTK_NDARRAY_STORAGE_HH
+
+#include <ftk/ftk_config.hh>
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ftk {
+
+// Contiguous elements of an ndarray, either owned by a std::vector or backed
+// by a read-only memory mapping of a file.  Mapped pages are loaded on first
+// access and shared with the page cache (and thus with other processes).
+// Copies of a mapped storage share the mapping, and the elements are copied
+// to owned storage on the first mutable access (non-const data(), [], 
+// begin() or end()), so that writes never reach the file or other copies.
+// Storage may also alias elements owned elsewhere, which are treated like
+// a mapping that is never unmapped.
+template <typename T>
+struct ndarray_storage {
+  typedef T value_type;
+
+  ndarray_storage() {}
+  ndarray_storage(const ndarray_storage& x) {*this = x;}
+  ndarray_storage(ndarray_storage&& x) {swap(x);}
+
+  ndarray_storage& operator=(const ndarray_storage& x);
+  ndarray_storage& operator=(ndarray_storage&& x) {swap(x); return *this;}
+  ndarray_storage& operator=(const std::vector<T>& v) {unmap(); vec = v; update(); return *this;}
+
+  size_t size() const {return n;}
+  bool empty() const {return n == 0;}
+  bool mapped() const {return mapping != nullptr;}
+
+  T* data() {unmap(); return vec.data();}
+  const T* data() const {return ptr;}
+
+  T& operator[](size_t i) {unmap(); return vec[i];}
+  const T& operator[](size_t i) const {return ptr[i];}
+
+  T* begin() {unmap(); return vec.data();}
+  T* end() {unmap(); return vec.data() + n;}
+  const T* begin() const {return ptr;}
+  const T* end() const {return ptr + n;}
+
+  void swap(ndarray_storage& x);
+
+  // modifiers that change the size copy mapped elements to owned storage first
+  void resize(size_t m);
+  void clear() {unmap(); vec.clear(); update();}
+  void push_back(const T& v) {unmap(); vec.push_back(v); update();}
+  template <typename Iterator> void assign(Iterator first, Iterator last) {unmap(); vec.assign(first, last); update();}
+  template <typename Iterator> void insert(const T* pos, Iterator first, Iterator last);
+
+  // maps m elements starting from the given byte offset of a file; returns
+  // false (leaving the storage unchanged) if the file cannot be mapped
+  bool map_file(const std::string& filename, size_t offset, size_t m);
+
+  // refers to m elements owned elsewhere, which must outlive the storage 
+  // and its copies; the elements are copied before they are written
+  void alias(const T *a, size_t m);
+
+private:
+  void unmap() {if (mapped()) copy_mapped();}
+  void copy_mapped(); // copies mapped elements to owned storage
+  void update() {ptr = vec.data(); n = vec.size();}
+
+private:
+  std::vector<T> vec;
+  std::shared_ptr<const void> mapping; // keeps the mapped region alive
+  const T *ptr = NULL; // mapped, aliased, or the elements of vec
+  size_t n = 0;
+};
+
+/////
+template <typename T>
+ndarray_storage<T>& ndarray_storage<T>::operator=(const ndarray_storage& x)
+{
+  if (this == &x) return *this;
+  if (x.mapped()) {
+    vec.clear();
+    mapping = x.mapping;
+    ptr = x.ptr;
+    n = x.n;
+  } else {
+    mapping.reset();
+    vec = x.vec;
+    update();
+  }
+  return *this;
+}
+
+template <typename T>
+void ndarray_storage<T>::swap(ndarray_storage& x)
+{
+  vec.swap(x.vec);
+  mapping.swap(x.mapping);
+  std::swap(ptr, x.ptr);
+  std::swap(n, x.n);
+}
+
+template <typename T>
+void ndarray_storage<T>::resize(size_t m)
+{
+  if (mapped() && m == n) return; // e.g. reshaping a mapped array
+  unmap();
+  vec.resize(m);
+  update();
+}
+
+template <typename T>
+template <typename Iterator>
+void ndarray_storage<T>::insert(const T* pos, Iterator first, Iterator last)
+{
+  const size_t i = pos - ptr;
+  unmap();
+  vec.insert(vec.begin() + i, first, last);
+  update();
+}
+
+template <typename T>
+void ndarray_storage<T>::copy_mapped()
+{
+  vec.assign(ptr, ptr + n);
+  mapping.reset();
+  update();
+}
+
+template <typename T>
+bool ndarray_storage<T>::map_file(const std::string& filename, size_t offset, size_t m)
+{
+  const size_t bytes = m * sizeof(T);
+  if (bytes == 0) return false;
+
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || offset + bytes > static_cast<size_t>(st.st_size)) {
+    close(fd);
+    return false;
+  }
+
+  // the offset of mmap must be a multiple of the page size
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t aligned_offset = offset / page_size * page_size,
+               length = offset - aligned_offset + bytes;
+
+  // read-only; the elements are copied before they are written
+  void *addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, aligned_offset);
+  close(fd); // the mapping holds its own reference to the file
+  if (addr == MAP_FAILED) return false;
+
+  vec.clear();
+  vec.shrink_to_fit();
+  mapping = std::shared_ptr<const void>(addr, [length](const void *a) {munmap(const_cast<void*>(a), length);});
+  ptr = reinterpret_cast<const T*>(static_cast<const char*>(addr) + offset - aligned_offset);
+  n = m;
+  return true;
+}
+
+
+template <typename T>
+void ndarray_storage<T>::alias(const T *a, size_t m)
+{
+  vec.clear();
+  vec.shrink_to_fit();
+  mapping = std::shared_ptr<const void>(static_cast<const void*>(a), [](const void*) {});
+  ptr = a;
+  n = m;
+}
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef _FTK_NDARRAY_VIEW_HH
+#define _FTK_NDARRAY_VIEW_HH
+
+#include <ftk/ftk_config.hh>
+#include <vector>
+#include <numeric>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace ftk {
+
+// Read-only view of elements of an ndarray or of external memory, with a
+// shape and a stride (in elements) for every dimension; the first index is
+// the fastest.  Slices, time slices and transposes of views are views of
+// the same elements, so nothing is copied until the view is materialized,
+// e.g. with ndarray::from_view.  The viewed memory must outlive the view.
+template <typename T>
+struct ndarray_view {
+  ndarray_view() {}
+  ndarray_view(const T *ptr, const std::vector<size_t>& dims); // contiguous
+  ndarray_view(const T *ptr, const std::vector<size_t>& dims, const std::vector<size_t>& strides)
+    : p(ptr), dims(dims), s(strides) {}
+
+  size_t nd() const {return dims.size();}
+  size_t dim(size_t i) const {return dims[i];}
+  size_t shape(size_t i) const {return dim(i);}
+  const std::vector<size_t>& shape() const {return dims;}
+  size_t stride(size_t i) const {return s[i];}
+  const std::vector<size_t>& strides() const {return s;}
+  size_t nelem() const {return std::accumulate(dims.begin(), dims.end(), size_t(1), std::multiplies<size_t>());}
+  bool empty() const {return p == NULL || nelem() == 0;}
+
+  const T* data() const {return p;} // the first element
+  bool contiguous() const; // if elements are dense in the order of ndarray
+
+  const T& at(const std::vector<size_t>& idx) const;
+  const T& operator()(const std::vector<size_t>& idx) const {return at(idx);}
+  const T& operator()(size_t i0) const {return p[i0*s[0]];}
+  const T& operator()(size_t i0, size_t i1) const {return p[i0*s[0]+i1*s[1]];}
+  const T& operator()(size_t i0, size_t i1, size_t i2) const {return p[i0*s[0]+i1*s[1]+i2*s[2]];}
+  const T& operator()(size_t i0, size_t i1, size_t i2, size_t i3) const {return p[i0*s[0]+i1*s[1]+i2*s[2]+i3*s[3]];}
+
+  ndarray_view<T> slice(const std::vector<size_t>& starts, const std::vector<size_t>& sizes) const;
+  ndarray_view<T> slice_time(size_t t) const; // drops the last dimension
+  ndarray_view<T> transpose() const; // reverses the dimensions
+  ndarray_view<T> transpose(const std::vector<size_t>& order) const; // the i-th dimension becomes order[i]
+
+  // copies the elements to dense memory in the order of ndarray
+  template <typename T1> void copy_to(T1 *out) const;
+
+private:
+  const T *p = NULL;
+  std::vector<size_t> dims, s;
+};
+
+/////
+template <typename T>
+ndarray_view<T>::ndarray_view(const T *ptr, const std::vector<size_t>& dims_)
+  : p(ptr), dims(dims_), s(dims_.size())
+{
+  for (size_t i = 0; i < nd(); i ++)
+    if (i == 0) s[i] = 1;
+    else s[i] = s[i-1]*dims[i-1];
+}
+
+template <typename T>
+bool ndarray_view<T>::contiguous() const
+{
+  size_t n = 1;
+  for (size_t i = 0; i < nd(); i ++) {
+    if (dims[i] > 1 && s[i] != n) return false;
+    n *= dims[i];
+  }
+  return true;
+}
+
+template <typename T>
+const T& ndarray_view<T>::at(const std::vector<size_t>& idx) const
+{
+  size_t i = 0;
+  for (size_t j = 0; j < nd(); j ++)
+    i += idx[j] * s[j];
+  return p[i];
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::slice(const std::vector<size_t>& st, const std::vector<size_t>& sz) const
+{
+  assert(st.size() == nd() && sz.size() == nd());
+  size_t offset = 0;
+  for (size_t i = 0; i < nd(); i ++) {
+    assert(st[i] + sz[i] <= dims[i]);
+    offset += st[i] * s[i];
+  }
+  return ndarray_view<T>(p + offset, sz, s);
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::slice_time(size_t t) const
+{
+  const size_t n = nd() - 1;
+  assert(t < dims[n]);
+  return ndarray_view<T>(p + t * s[n],
+      std::vector<size_t>(dims.begin(), dims.begin() + n),
+      std::vector<size_t>(s.begin(), s.begin() + n));
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::transpose() const
+{
+  std::vector<size_t> order(nd());
+  for (size_t i = 0; i < nd(); i ++)
+    order[i] = nd() - 1 - i;
+  return transpose(order);
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::transpose(const std::vector<size_t>& order) const
+{
+  assert(order.size() == nd());
+  std::vector<size_t> dims1(nd()), s1(nd());
+  for (size_t i = 0; i < nd(); i ++) {
+    dims1[i] = dims[order[i]];
+    s1[i] = s[order[i]];
+  }
+  return ndarray_view<T>(p, dims1, s1);
+}
+
+template <typename T>
+template <typename T1>
+void ndarray_view<T>::copy_to(T1 *out) const
+{
+  if (nd() == 0 || empty()) return;
+  if (contiguous()) {
+    std::copy(p, p + nelem(), out);
+    return;
+  }
+
+  // rows along the first dimension, which are contiguous if s[0] is 1
+  const size_t n0 = dims[0], s0 = s[0];
+  std::vector<size_t> idx(nd(), 0);
+  while (1) {
+    const T *row = p;
+    for (size_t i = 1; i < nd(); i ++)
+      row += idx[i] * s[i];
+
+    if (s0 == 1) std::copy(row, row + n0, out);
+    else
+      for (size_t j = 0; j < n0; j ++)
+        out[j] = row[j * s0];
+    out += n0;
+
+    size_t i = 1; // next row
+    for (; i < nd(); i ++) {
+      if (++ idx[i] < dims[i]) break;
+      else idx[i] = 0;
+    }
+    if (i >= nd()) break;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef _FTK_INVERSE_LINEAR_INTERPOLATION_SOLVER_BATCH_HH
+#define _FTK_INVERSE_LINEAR_INTERPOLATION_SOLVER_BATCH_HH
+
+#include <ftk/numeric/simd.hh>
+#include <limits>
+
+namespace ftk {
+
+// Structure-of-arrays variants of inverse_lerp_s2v2 and inverse_lerp_s3v3
+// that solve W simplices per call, e.g. V[i][j][k] is the j-th component
+// of the i-th vertex of the k-th simplex.  W is a multiple of the vector
+// width (4, 8 or 16 for both float and double); results and succ[k] are
+// identical to the scalar functions.
+template <int W, typename T>
+void inverse_lerp_s2v2_batch(const T V[3][2][W], T mu[3][W], int succ[W],
+    const T epsilon = std::numeric_limits<T>::epsilon(), int isa = simd_isa());
+
+template <int W, typename T>
+void inverse_lerp_s3v3_batch(const T V[4][3][W], T lambda[4][W], int succ[W],
+    int isa = simd_isa());
+
+/////
+template <typename V, int W, typename T>
+FTK_SIMD_INLINE void inverse_lerp_s2v2_lanes(const T Vs[3][2][W], T mu[3][W], int succ[W], const T epsilon)
+{
+  for (int k = 0; k < W; k += sizeof(V) / sizeof(T)) {
+    V v[3][2];
+    for (int i = 0; i < 3; i ++)
+      for (int j = 0; j < 2; j ++)
+        simd_load(v[i][j], &Vs[i][j][k]);
+
+    // same as solve_linear2x2
+    const V A00 = v[0][0] - v[2][0], A01 = v[1][0] - v[2][0],
+            A10 = v[0][1] - v[2][1], A11 = v[1][1] - v[2][1];
+    const V b0 = -v[2][0], b1 = -v[2][1];
+    const V D  = A00 * A11 - A10 * A01,
+            Dx = b0  * A11 - A01 * b1,
+            Dy = A00 * b1  - b0  * A10;
+
+    const V mu0 = Dx / D, mu1 = Dy / D;
+    const V mu2 = T(1) - mu0 - mu1;
+    simd_store(&mu[0][k], mu0);
+    simd_store(&mu[1][k], mu1);
+    simd_store(&mu[2][k], mu2);
+
+    const T lo = -epsilon, hi = T(1) + epsilon;
+    simd_store_mask(succ + k,
+        (mu0 >= lo) & (mu0 <= hi) & (mu1 >= lo) & (mu1 <= hi) & (mu2 >= lo) & (mu2 <= hi));
+  }
+}
+
+template <typename V, int W, typename T>
+FTK_SIMD_INLINE void inverse_lerp_s3v3_lanes(const T Vs[4][3][W], T lambda[4][W], int succ[W])
+{
+  for (int k = 0; k < W; k += sizeof(V) / sizeof(T)) {
+    V v[4][3];
+    for (int i = 0; i < 4; i ++)
+      for (int j = 0; j < 3; j ++)
+        simd_load(v[i][j], &Vs[i][j][k]);
+
+    V m[3][3], b[3];
+    for (int j = 0; j < 3; j ++) {
+      for (int i = 0; i < 3; i ++)
+        m[j][i] = v[i][j] - v[3][j];
+      b[j] = -v[3][j];
+    }
+
+    // same as solve_linear3x3
+    V inv[3][3];
+    inv[0][0] =   m[1][1]*m[2][2] - m[1][2]*m[2][1];
+    inv[0][1] = - m[0][1]*m[2][2] + m[0][2]*m[2][1];
+    inv[0][2] =   m[0][1]*m[1][2] - m[0][2]*m[1][1];
+    inv[1][0] = - m[1][0]*m[2][2] + m[1][2]*m[2][0];
+    inv[1][1] =   m[0][0]*m[2][2] - m[0][2]*m[2][0];
+    inv[1][2] = - m[0][0]*m[1][2] + m[0][2]*m[1][0];
+    inv[2][0] =   m[1][0]*m[2][1] - m[1][1]*m[2][0];
+    inv[2][1] = - m[0][0]*m[2][1] + m[0][1]*m[2][0];
+    inv[2][2] =   m[0][0]*m[1][1] - m[0][1]*m[1][0];
+
+    const V det = m[0][0]*inv[0][0] + m[0][1]*inv[1][0] + m[0][2]*inv[2][0];
+    const V invdet = T(1) / det;
+    for (int i = 0; i < 3; i ++)
+      for (int j = 0; j < 3; j ++)
+        inv[i][j] = inv[i][j] * invdet;
+
+    V l[4];
+    for (int i = 0; i < 3; i ++)
+      l[i] = inv[i][0] * b[0] + inv[i][1] * b[1] + inv[i][2] * b[2];
+    l[3] = T(1) - l[0] - l[1] - l[2];
+    for (int i = 0; i < 4; i ++)
+      simd_store(&lambda[i][k], l[i]);
+
+    simd_store_mask(succ + k,
+        (l[0] >= T(0)) & (l[0] < T(1)) & (l[1] >= T(0)) & (l[1] < T(1)) &
+        (l[2] >= T(0)) & (l[2] < T(1)) & (l[3] >= T(0)) & (l[3] < T(1)));
+  }
+}
+
+#if FTK_SIMD_X86
+template <int W, typename T>
+FTK_SIMD_TARGET("avx2")
+void inverse_lerp_s2v2_batch_avx2(const T V[3][2][W], T mu[3][W], int succ[W], const T epsilon)
+{
+  inverse_lerp_s2v2_lanes<typename simd_vector<T>::avx2, W>(V, mu, succ, epsilon);
+}
+
+template <int W, typename T>
+FTK_SIMD_TARGET("avx512f")
+void inverse_lerp_s2v2_batch_avx512(const T V[3][2][W], T mu[3][W], int succ[W], const T epsilon)
+{
+  inverse_lerp_s2v2_lanes<typename simd_vector<T>::avx512, W>(V, mu, succ, epsilon);
+}
+
+template <int W, typename T>
+FTK_SIMD_TARGET("avx2")
+void inverse_lerp_s3v3_batch_avx2(const T V[4][3][W], T lambda[4][W], int succ[W])
+{
+  inverse_lerp_s3v3_lanes<typename simd_vector<T>::avx2, W>(V, lambda, succ);
+}
+
+template <int W, typename T>
+FTK_SIMD_TARGET("avx512f")
+void inverse_lerp_s3v3_batch_avx512(const T V[4][3][W], T lambda[4][W], int succ[W])
+{
+  inverse_lerp_s3v3_lanes<typename simd_vector<T>::avx512, W>(V, lambda, succ);
+}
+#endif
+
+template <int W, typename T>
+void inverse_lerp_s2v2_batch(const T V[3][2][W], T mu[3][W], int succ[W], const T epsilon, int isa)
+{
+#if FTK_SIMD_X86
+  const int w = 64 / sizeof(T); // lanes of a 512-bit vector
+  if (isa >= SIMD_AVX512 && W % w == 0)
+    return inverse_lerp_s2v2_batch_avx512<W>(V, mu, succ, epsilon);
+  else if (isa >= SIMD_AVX2 && W % (w/2) == 0)
+    return inverse_lerp_s2v2_batch_avx2<W>(V, mu, succ, epsilon);
+#endif
+  inverse_lerp_s2v2_lanes<T, W>(V, mu, succ, epsilon);
+}
+
+template <int W, typename T>
+void inverse_lerp_s3v3_batch(const T V[4][3][W], T lambda[4][W], int succ[W], int isa)
+{
+#if FTK_SIMD_X86
+  const int w = 64 / sizeof(T);
+  if (isa >= SIMD_AVX512 && W % w == 0)
+    return inverse_lerp_s3v3_batch_avx512<W>(V, lambda, succ);
+  else if (isa >= SIMD_AVX2 && W % (w/2) == 0)
+    return inverse_lerp_s3v3_batch_avx2<W>(V, lambda, succ);
+#endif
+  inverse_lerp_s3v3_lanes<T, W>(V, lambda, succ);
+}
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef _FTK_SIMD_HH
+#define _FTK_SIMD_HH
+
+#include <ftk/ftk_config.hh>
+#include <cstring>
+
+// Batched kernels are written once over a vector type V, which is either a
+// scalar (the portable fallback) or a GCC vector extension type of the
+// width of the instruction set; the kernels are inlined into functions that
+// are compiled for AVX2 or AVX-512 and selected at runtime.  Fused
+// multiply-adds are disabled in these functions so that all paths produce
+// bitwise identical results.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(__CUDACC__)
+#define FTK_SIMD_X86 1
+#define FTK_SIMD_INLINE __attribute__((always_inline)) inline
+#if defined(__clang__)
+#define FTK_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FTK_SIMD_TARGET(isa) __attribute__((target(isa), optimize("fp-contract=off")))
+#endif
+#else
+#define FTK_SIMD_X86 0
+#define FTK_SIMD_INLINE inline
+#endif
+
+namespace ftk {
+
+enum {
+  SIMD_NONE = 0,
+  SIMD_AVX2 = 1,
+  SIMD_AVX512 = 2
+};
+
+// the widest instruction set supported by the processor
+inline int simd_isa()
+{
+#if FTK_SIMD_X86
+  static const int isa =
+    __builtin_cpu_supports("avx512f") ? SIMD_AVX512 :
+    __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_NONE;
+  return isa;
+#else
+  return SIMD_NONE;
+#endif
+}
+
+#if FTK_SIMD_X86
+typedef double simd_double4 __attribute__((vector_size(32)));
+typedef double simd_double8 __attribute__((vector_size(64)));
+typedef float simd_float8 __attribute__((vector_size(32)));
+typedef float simd_float16 __attribute__((vector_size(64)));
+
+// vector types of 256 and 512 bits
+template <typename T> struct simd_vector {};
+template <> struct simd_vector<double> {typedef simd_double4 avx2; typedef simd_double8 avx512;};
+template <> struct simd_vector<float> {typedef simd_float8 avx2; typedef simd_float16 avx512;};
+#endif
+
+template <typename V, typename T>
+FTK_SIMD_INLINE void simd_load(V& v, const T *p)
+{
+  memcpy(&v, p, sizeof(V));
+}
+
+template <typename V, typename T>
+FTK_SIMD_INLINE void simd_store(T *p, const V& v)
+{
+  memcpy(p, &v, sizeof(V));
+}
+
+// masks of comparisons are vectors of all-one or zero lanes, or bools/ints
+// for scalars
+template <typename M>
+FTK_SIMD_INLINE void simd_store_mask(int *p, const M& m)
+{
+  for (size_t i = 0; i < sizeof(M) / sizeof(m[0]); i ++)
+    p[i] = m[i] != 0;
+}
+
+FTK_SIMD_INLINE void simd_store_mask(int *p, int m) {p[0] = m != 0;}
+
+}
+
+#endif
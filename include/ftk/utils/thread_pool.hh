@@ -0,0 +1,150 @@
+#ifndef _FTK_THREAD_POOL_HH
+#define _FTK_THREAD_POOL_HH
+
+#include <ftk/ftk_config.hh>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+namespace ftk {
+
+// A persistent pool of worker threads.  The calling thread participates as
+// thread 0, so a pool of size n spawns n-1 workers that sleep between jobs.
+struct thread_pool {
+  thread_pool(int nthreads);
+  ~thread_pool();
+
+  int size() const {return nthreads;}
+
+  // Run f(tid) on every thread of the pool and wait for all of them
+  void run(const std::function<void(int)>& f);
+
+  // Run f(task, tid) for all tasks in [0, ntasks).  Each thread starts with
+  // a contiguous range of tasks, claimed grain tasks at a time; threads that
+  // finish their own range steal the remaining tasks of the others.
+  template <typename F> void parallel_for(size_t ntasks, F&& f, size_t grain = 1);
+
+private:
+  void worker(int tid);
+
+private:
+  const int nthreads;
+  std::vector<std::thread> workers;
+
+  std::mutex run_mutex; // serializes concurrent run() calls
+  std::mutex mutex;
+  std::condition_variable cv_job, cv_done;
+  const std::function<void(int)> *job = NULL;
+  size_t generation = 0;
+  int npending = 0;
+  bool stopping = false;
+  std::atomic<bool> running {false};
+};
+
+/////
+inline thread_pool::thread_pool(int n) : nthreads(std::max(n, 1))
+{
+  for (int i = 1; i < nthreads; i ++)
+    workers.push_back(std::thread([this, i]() {worker(i);}));
+}
+
+inline thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  cv_job.notify_all();
+  for (auto &t : workers)
+    t.join();
+}
+
+inline void thread_pool::worker(int tid)
+{
+  size_t my_generation = 0;
+  while (1) {
+    const std::function<void(int)> *f;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv_job.wait(lock, [&]() {return stopping || generation != my_generation;});
+      if (stopping) return;
+      my_generation = generation;
+      f = job;
+    }
+
+    (*f)(tid);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (-- npending == 0)
+        cv_done.notify_one();
+    }
+  }
+}
+
+inline void thread_pool::run(const std::function<void(int)>& f)
+{
+  if (running || nthreads == 1) { // nested or single-threaded calls run serially
+    for (int i = 0; i < nthreads; i ++)
+      f(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lock(run_mutex);
+  running = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &f;
+    npending = nthreads - 1;
+    generation ++;
+  }
+  cv_job.notify_all();
+
+  f(0);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv_done.wait(lock, [&]() {return npending == 0;});
+    job = NULL;
+  }
+  running = false;
+}
+
+template <typename F>
+void thread_pool::parallel_for(size_t ntasks, F&& f, size_t grain)
+{
+  struct range {
+    std::atomic<size_t> next;
+    size_t end;
+    char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)]; // avoid false sharing
+  };
+
+  grain = std::max(grain, size_t(1));
+  std::unique_ptr<range[]> ranges(new range[nthreads]);
+  for (int i = 0; i < nthreads; i ++) {
+    ranges[i].next = ntasks * i / nthreads;
+    ranges[i].end = ntasks * (i + 1) / nthreads;
+  }
+
+  run([&](int tid) {
+    for (int k = 0; k < nthreads; k ++) { // own range first, then steal from others
+      range &r = ranges[(tid + k) % nthreads];
+      while (1) {
+        const size_t i0 = r.next.fetch_add(grain);
+        if (i0 >= r.end) break;
+        const size_t i1 = std::min(i0 + grain, r.end);
+        for (size_t i = i0; i < i1; i ++)
+          f(i, tid);
+      }
+    }
+  });
+}
+
+}
+
+#endif
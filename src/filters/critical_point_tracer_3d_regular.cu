@@ -67,7 +67,7 @@ bool check_simplex_cp3t(
       double values[4];
       for (int i = 0; i < 4; i ++) {
         size_t ii = ext.to_index(vertices[i]);
-        int t = unit_simplex_offset_3_2<scope>(e.type, i, 3);
+        int t = unit_simplex_offset_4_3<scope>(e.type, i, 3);
         values[i] = scalar[t][ii];
       }
       cp.scalar = ftk::lerp_s3(values, mu);
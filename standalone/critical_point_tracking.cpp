@@ -1,5 +1,9 @@
 #include <fstream>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <set>
 #include <cassert>
 #include "ftk/external/cxxopts.hpp"
@@ -58,6 +62,15 @@ std::string output_filename,
 std::vector<std::string> input_filenames; // assuming each file contains only one timestep, and all files have the exactly same structure
 size_t DW = 0, DH = 0, DD = 0, DT = 0;
 bool verbose = false, demo = false, show_vtk = false, help = false;
+bool stream = false;
+bool use_mmap = false;
+bool use_float = false;
+bool lazy_jacobian = false;
+int prefetch_depth = 2; // number of timesteps read ahead; 0 disables prefetching
+size_t prefetch_memory_limit = 0; // in MB; 0 is unlimited
+int rebalance_interval = 0;
+int ntime_windows = 1;
+int nthreads = 0; // 0 for the cores of the proc
 
 // determined later
 int nd, // dimensionality
@@ -75,24 +88,79 @@ size_t dimlens[4] = {0}; // Only for netcdf
 
 // tracker
 ftk::critical_point_tracker_regular* tracker = NULL;
+bool partial_input = false; // with multiple procs, every proc reads only its block
+
+// the block of the input arrays that is read by this proc, with the 
+// components of vector fields
+ftk::lattice input_block()
+{
+  const ftk::lattice &l = tracker->get_local_array_domain();
+  std::vector<size_t> starts = l.starts(), sizes = l.sizes();
+  if (nv > 1) {
+    starts.insert(starts.begin(), 0);
+    sizes.insert(sizes.begin(), nv);
+  }
+  return ftk::lattice(starts, sizes);
+}
+
+// reads the spatial block of a netcdf variable, of which the first 
+// netcdf dimension may be time
+void read_netcdf_block(ftk::ndarray<double>& array, const std::string& filename, 
+    const std::string& varname, const ftk::lattice& block)
+{
+  std::vector<size_t> starts, sizes;
+  if (ncdims == nd + 1) {
+    starts.push_back(0);
+    sizes.push_back(1);
+  }
+  for (int i = nd - 1; i >= 0; i --) { // netcdf dimensions are in C order
+    starts.push_back(block.start(i));
+    sizes.push_back(block.size(i));
+  }
+  array.from_netcdf(filename, varname, starts.data(), sizes.data());
+}
 
 
 ///////////////////////////////
-ftk::ndarray<double> request_timestep(int k) // requesting k-th timestep
+std::vector<size_t> input_shape() // of a timestep, with the components of vector fields
 {
-  std::vector<size_t> shape;
   if (nd == 2) {
-    if (nv == 1) shape = std::vector<size_t>({DW, DH});
-    else shape = std::vector<size_t>({size_t(nv), DW, DH});
+    if (nv == 1) return std::vector<size_t>({DW, DH});
+    else return std::vector<size_t>({size_t(nv), DW, DH});
   } else {
-    if (nv == 1) shape = std::vector<size_t>({DW, DH, DD});
-    else shape = std::vector<size_t>({size_t(nv), DW, DH, DD});
+    if (nv == 1) return std::vector<size_t>({DW, DH, DD});
+    else return std::vector<size_t>({size_t(nv), DW, DH, DD});
   }
+}
+
+// reads the k-th timestep of a raw (float32 or float64) file in its own precision
+template <typename T>
+ftk::ndarray<T> read_raw_timestep(int k)
+{
+  const std::string filename = input_filenames[k];
+  const std::vector<size_t> shape = input_shape();
+
+  ftk::ndarray<T> array;
+  if (partial_input) array.from_binary_file(filename, shape, input_block());
+  else if (use_mmap) array.from_binary_file_mmap(filename, shape); // no copy
+  else {
+    array.reshape(shape);
+    array.from_binary_file(filename);
+  }
+  return array;
+}
+
+// reads the k-th timestep of other formats in double precision
+ftk::ndarray<double> read_timestep(int k)
+{
+  const std::vector<size_t> shape = input_shape();
+  const ftk::lattice block = partial_input ? input_block() : ftk::lattice(shape);
 
   if (demo) {
     if (nd == 2) {
       const double t = DT == 1 ? 0.0 : double(k)/(DT-1);
-      return ftk::synthetic_woven_2D<double>(DW, DH, t);
+      auto array = ftk::synthetic_woven_2D<double>(DW, DH, t);
+      return partial_input ? array.slice(block) : array;
     } else { // nd == 3
       fprintf(stderr, "3D demo case not available.\n");
       assert(false); // TODO: create a 3D demo case
@@ -101,19 +169,7 @@ ftk::ndarray<double> request_timestep(int k) // requesting k-th timestep
   } else {
     const std::string filename = input_filenames[k];
 
-    if (input_format == str_float32) {
-      ftk::ndarray<float> array32(shape);
-      array32.from_binary_file(filename);
-      
-      ftk::ndarray<double> array(shape);
-      array.from_array(array32);
-
-      return array;
-    } else if (input_format == str_float64) {
-      ftk::ndarray<double> array(shape);
-      array.from_binary_file(filename);
-      return array;
-    } else if (input_format == str_vti) {
+    if (input_format == str_vti) {
       ftk::ndarray<double> array;
 
       if (input_variable_name.size() > 0) { // all data in one single variable; channels are automatically handled in ndarray
@@ -133,13 +189,27 @@ ftk::ndarray<double> request_timestep(int k) // requesting k-th timestep
         }
       }
 
-      return array;
+      return partial_input ? array.slice(block) : array; // vti files are read entirely
     } else if (input_format == str_netcdf) {
       ftk::ndarray<double> array;
 
       if (input_variable_name.size() > 0) { // all data in one single variable; channels are automatically handled in ndarray
-        array.from_netcdf(filename, input_variable_name);
-      } else { // u, v, w in separate variables
+        if (partial_input && nv == 1) read_netcdf_block(array, filename, input_variable_name, block);
+        else array.from_netcdf(filename, input_variable_name);
+      } else if (partial_input) { // u, v, w in separate variables
+        ftk::ndarray<double> u, v, w;
+        read_netcdf_block(u, filename, input_variable_name_u, block);
+        read_netcdf_block(v, filename, input_variable_name_v, block);
+        if (nv > 2)
+          read_netcdf_block(w, filename, input_variable_name_w, block);
+
+        array.reshape(block.sizes());
+        for (auto i = 0; i < u.nelem(); i ++) {
+          array[i*nv] = u[i];
+          array[i*nv+1] = v[i];
+          if (nv > 2) array[i*nv+2] = w[i];
+        }
+      } else {
         ftk::ndarray<double> u, v, w;
         u.from_netcdf(filename, input_variable_name_u);
         v.from_netcdf(filename, input_variable_name_v);
@@ -154,7 +224,11 @@ ftk::ndarray<double> request_timestep(int k) // requesting k-th timestep
         }
       }
 
-      array.reshape(shape); // ncdims may not be equal to nd
+      if (partial_input && array.nelem() != block.n()) { // a single vector variable
+        array.reshape(shape); // ncdims may not be equal to nd
+        return array.slice(block);
+      }
+      array.reshape(block.sizes()); // ncdims may not be equal to nd
       return array;
     } else if (input_format == str_hdf5) {
       // TODO
@@ -167,6 +241,112 @@ ftk::ndarray<double> request_timestep(int k) // requesting k-th timestep
   }
 }
 
+template <typename T>
+void convert_timestep(ftk::ndarray<T>&& in, ftk::ndarray<T>& out) {out = std::move(in);}
+
+template <typename T, typename T1>
+void convert_timestep(ftk::ndarray<T1>&& in, ftk::ndarray<T>& out)
+{
+  out.reshape(in.shape());
+  out.from_array(in);
+}
+
+// requests the k-th timestep in the precision T of the tracker; raw files 
+// are converted at most once, and mapped files of the same precision are 
+// not copied
+template <typename T>
+ftk::ndarray<T> request_timestep(int k)
+{
+  ftk::ndarray<T> array;
+  if (!demo && input_format == str_float32) 
+    convert_timestep(read_raw_timestep<float>(k), array);
+  else if (!demo && input_format == str_float64) 
+    convert_timestep(read_raw_timestep<double>(k), array);
+  else
+    convert_timestep(read_timestep(k), array);
+  return array;
+}
+
+// Reads the timesteps [t0, t1) in order on a background thread, so that I/O 
+// overlaps with tracking.  At most `depth' timesteps are buffered, and no more are read if 
+// the buffered timesteps would exceed `max_bytes' (0 for unlimited).  Reads 
+// are serialized, as I/O libraries such as NetCDF are not thread-safe.
+template <typename T>
+struct timestep_prefetcher {
+  timestep_prefetcher(int t0_, int t1_, size_t depth_, size_t max_bytes_) 
+    : t0(t0_), t1(t1_), depth(depth_), max_bytes(max_bytes_), worker([this]() {run();}) {}
+  ~timestep_prefetcher();
+
+  ftk::ndarray<T> get(); // the next timestep
+
+private:
+  void run();
+
+private:
+  const int t0, t1;
+  const size_t depth, max_bytes;
+
+  std::mutex mutex;
+  std::condition_variable cond_data, cond_space;
+  std::deque<ftk::ndarray<T>> queue;
+  size_t bytes = 0, last_bytes = 0;
+  bool stop = false;
+
+  std::thread worker;
+};
+
+template <typename T>
+timestep_prefetcher<T>::~timestep_prefetcher()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    stop = true;
+  }
+  cond_space.notify_all();
+  worker.join();
+}
+
+template <typename T>
+void timestep_prefetcher<T>::run()
+{
+  for (int k = t0; k < t1; k ++) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond_space.wait(lock, [&]() {
+        return stop || queue.empty() || (queue.size() < depth 
+            && (max_bytes == 0 || bytes + last_bytes <= max_bytes));
+      });
+      if (stop) return;
+    }
+
+    ftk::ndarray<T> array = request_timestep<T>(k);
+    const size_t n = array.nelem() * sizeof(T);
+
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      bytes += n;
+      last_bytes = n;
+      queue.emplace_back(std::move(array));
+    }
+    cond_data.notify_one();
+  }
+}
+
+template <typename T>
+ftk::ndarray<T> timestep_prefetcher<T>::get()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  cond_data.wait(lock, [&]() {return !queue.empty();});
+
+  ftk::ndarray<T> array = std::move(queue.front());
+  queue.pop_front();
+  bytes -= array.nelem() * sizeof(T);
+  lock.unlock();
+
+  cond_space.notify_one();
+  return array;
+}
+
 inline bool ends_with(std::string const & value, std::string const & ending)
 {
   if (ending.size() > value.size()) return false;
@@ -202,6 +382,24 @@ int parse_arguments(int argc, char **argv)
      cxxopts::value<std::string>(output_filename))
     ("r,output-format", "Output format (auto|text|vtp)", 
      cxxopts::value<std::string>(output_format)->default_value("auto"))
+    ("stream", "Trace trajectories incrementally as timesteps are processed", 
+     cxxopts::value<bool>(stream))
+    ("mmap", "Memory-map raw (float32/float64) input files instead of reading them", 
+     cxxopts::value<bool>(use_mmap))
+    ("float", "Store field data in single precision to reduce memory footprint", 
+     cxxopts::value<bool>(use_float))
+    ("lazy-jacobian", "Evaluate the derived jacobian only where critical points are found", 
+     cxxopts::value<bool>(lazy_jacobian))
+    ("prefetch", "Number of timesteps read ahead in the background (0 to disable)", 
+     cxxopts::value<int>(prefetch_depth)->default_value("2"))
+    ("prefetch-memory", "Memory limit of prefetched timesteps in MB (0 for unlimited)", 
+     cxxopts::value<size_t>(prefetch_memory_limit)->default_value("0"))
+    ("rebalance", "Rebalance the blocks of procs by the cost of tracking every n timesteps (0 to disable)", 
+     cxxopts::value<int>(rebalance_interval)->default_value("0"))
+    ("nthreads", "Number of threads per proc (0 for the cores available to the proc)", 
+     cxxopts::value<int>(nthreads)->default_value("0"))
+    ("time-windows", "Number of groups of procs that track consecutive windows of timesteps", 
+     cxxopts::value<int>(ntime_windows)->default_value("1"))
     ("vtk", "Show visualization with vtk", 
      cxxopts::value<bool>(show_vtk))
     ("v,verbose", "Verbose outputs", cxxopts::value<bool>(verbose))
@@ -227,6 +425,14 @@ int parse_arguments(int argc, char **argv)
     fatal("invalid '--input-format'");
   if (set_valid_output_format.find(output_format) == set_valid_output_format.end())
     fatal("invalid '--output-format'");
+  if (prefetch_depth < 0)
+    fatal("invalid '--prefetch'");
+  if (ntime_windows < 1)
+    fatal("invalid '--time-windows'");
+  if (nthreads < 0)
+    fatal("invalid '--nthreads'");
+  if (ntime_windows > 1 && (stream || rebalance_interval > 0))
+    fatal("'--time-windows' cannot be used with '--stream' or '--rebalance'");
  
   if (input_dimension == str_auto || input_dimension.size() == 0) nd = 0; // auto
   else if (input_dimension == str_two) nd = 2;
@@ -502,6 +708,14 @@ int parse_arguments(int argc, char **argv)
   fprintf(stderr, "DT=%zu\n", DT);
   fprintf(stderr, "=============\n");
 
+  if (ntime_windows > 1) {
+    diy::mpi::communicator world;
+    if (world.size() % ntime_windows != 0)
+      fatal("the number of procs must be a multiple of '--time-windows'");
+    if (DT < static_cast<size_t>(ntime_windows) + 1)
+      fatal("'--time-windows' exceeds the number of timestep intervals");
+  }
+
   assert(nd == 2 || nd == 3);
   assert(nv == 1 || nv == 2 || nv == 3);
   assert(DT > 0);
@@ -509,17 +723,50 @@ int parse_arguments(int argc, char **argv)
   return 0;
 }
 
+// pushes the timesteps [t0, t1] to the tracker in its precision T
+template <typename T>
+void push_timesteps(int t0, int t1)
+{
+  // blocks that are read ahead would be stale after rebalancing
+  std::unique_ptr<timestep_prefetcher<T>> prefetcher;
+  if (prefetch_depth > 0 && !(partial_input && rebalance_interval > 0)) 
+    prefetcher.reset(new timestep_prefetcher<T>(t0, t1 + 1, prefetch_depth, prefetch_memory_limit << 20));
+
+  int current_timestep = t0;
+  while (1) {
+    ftk::ndarray<T> field_data = prefetcher ? 
+      prefetcher->get() : request_timestep<T>(current_timestep);
+    if (nv == 1) // scalar field
+      tracker->push_scalar_field_snapshot(std::move(field_data));
+    else // vector field
+      tracker->push_vector_field_snapshot(std::move(field_data));
+     
+    if (current_timestep == t1) {
+      tracker->update_timestep();
+      break;
+    }
+    else if (current_timestep != t0) // need to push two timestep before one can advance timestep
+      tracker->advance_timestep();
+    current_timestep ++;
+  }
+}
+
 void track_critical_points()
 {
   if (nd == 2) {
-    tracker = new ftk::critical_point_tracker_2d_regular;
+    if (use_float) tracker = new ftk::critical_point_tracker_2d_regular_t<float>;
+    else tracker = new ftk::critical_point_tracker_2d_regular;
     tracker->set_array_domain(ftk::lattice({0, 0}, {DW, DH}));
   } else {
-    tracker = new ftk::critical_point_tracker_3d_regular;
+    if (use_float) tracker = new ftk::critical_point_tracker_3d_regular_t<float>;
+    else tracker = new ftk::critical_point_tracker_3d_regular;
     tracker->set_array_domain(ftk::lattice({0, 0, 0}, {DW, DH, DD}));
   }
       
-  tracker->set_input_array_partial(false); // input data are not distributed
+  // with multiple procs, every proc reads only its block of the input arrays
+  diy::mpi::communicator world;
+  partial_input = world.size() > 1;
+  tracker->set_input_array_partial(partial_input);
   
   if (nv == 1) { // scalar field
     tracker->set_scalar_field_source( ftk::SOURCE_GIVEN );
@@ -540,24 +787,23 @@ void track_critical_points()
       tracker->set_domain(ftk::lattice({1, 1, 1}, {DW-2, DH-2, DD-2})); // the indentation is needed becase the jacoobian field will be automatically derived
     }
   }
+  tracker->set_jacobian_field_lazy(lazy_jacobian);
+  tracker->set_streaming_trajectories(stream);
+  tracker->set_rebalance_interval(rebalance_interval);
+  if (nthreads > 0) 
+    tracker->set_number_of_threads(nthreads);
+  if (ntime_windows > 1) {
+    tracker->set_end_timestep(DT - 1);
+    tracker->set_number_of_time_windows(ntime_windows);
+  }
   tracker->initialize();
 
-  int current_timestep = 0;
-  while (1) {
-    ftk::ndarray<double> field_data = request_timestep(current_timestep);
-    if (nv == 1) // scalar field
-      tracker->push_scalar_field_snapshot(field_data);
-    else // vector field
-      tracker->push_vector_field_snapshot(field_data);
-     
-    if (current_timestep == DT - 1) {
-      tracker->update_timestep();
-      break;
-    }
-    else if (current_timestep != 0) // need to push two timestep before one can advance timestep
-      tracker->advance_timestep();
-    current_timestep ++;
-  }
+  // the timesteps of the time window of this proc, or all timesteps
+  const int t0 = ntime_windows > 1 ? tracker->get_local_start_timestep() : 0, 
+            t1 = ntime_windows > 1 ? tracker->get_local_end_timestep() : static_cast<int>(DT) - 1;
+
+  if (use_float) push_timesteps<float>(t0, t1);
+  else push_timesteps<double>(t0, t1);
 
   tracker->finalize();
   // delete tracker;
@@ -617,6 +863,8 @@ void start_vtk_window()
 
 int main(int argc, char **argv)
 {
+  diy::mpi::environment env(argc, argv);
+
   parse_arguments(argc, argv);
   track_critical_points();
     
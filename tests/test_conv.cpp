@@ -85,3 +85,41 @@ TEST_F(conv_test, 3D_conv_gaussian_test) {
   r.to_vector(res);
   EXPECT_EQ(res,ans);
 }
+TEST_F(conv_test, gaussian_separable_test) {
+  ftk::ndarray<double> d({9,7,5}), r0, r1;
+  for (size_t i = 0; i < d.nelem(); i ++)
+    d[i] = std::sin(0.37 * i) + 0.1 * i;
+
+  for (size_t padding = 0; padding < 3; padding ++) {
+    r0 = ftk::conv3D(d, ftk::gaussian_kernel3D(1.5, 5, 3, 3), padding);
+    r1 = ftk::conv3D_gaussian(d, 1.5, 5, 3, 3, padding);
+    EXPECT_EQ(r0.shape(), r1.shape());
+    for (size_t i = 0; i < r0.nelem(); i ++)
+      EXPECT_NEAR(r0[i], r1[i], epsilon);
+  }
+
+  // in place
+  r1 = d;
+  ftk::conv_gaussian_separable(r1, r1, 1.5, {5, 3, 3}, 2);
+  r0 = ftk::conv3D(d, ftk::gaussian_kernel3D(1.5, 5, 3, 3), 2);
+  for (size_t i = 0; i < r0.nelem(); i ++)
+    EXPECT_NEAR(r0[i], r1[i], epsilon);
+}
+TEST_F(conv_test, gaussian_recursive_test) {
+  // constants are preserved, and the filter approximates a wide gaussian
+  ftk::ndarray<double> d;
+  d.reshape({64, 48}, 3.0);
+  ftk::gaussian_filter_recursive(d, 4.0);
+  for (size_t i = 0; i < d.nelem(); i ++)
+    EXPECT_NEAR(d[i], 3.0, 1e-9);
+
+  const double sigma = 5.0;
+  ftk::ndarray<double> f;
+  f.reshape(std::vector<size_t>({201}), 0.0);
+  f[100] = 1.0;
+  ftk::gaussian_filter_recursive(f, sigma);
+  for (int i = 0; i < 201; i ++) {
+    const double x = i - 100;
+    EXPECT_NEAR(f[i], std::exp(-x*x/(2*sigma*sigma)) / (std::sqrt(2*M_PI)*sigma), 4e-3); // within 5% of the peak
+  }
+}
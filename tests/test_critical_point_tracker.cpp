@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <algorithm>
+#include <ftk/filters/critical_point_tracker_2d_regular.hh>
+#include <ftk/filters/critical_point_tracker_3d_regular.hh>
+#include <ftk/ndarray/synthetic.hh>
+
+class critical_point_tracker_test : public testing::Test {
+public:
+  // points of all trajectories, sorted
+  template <int N>
+  static std::vector<ftk::critical_point_t<N, double>> sorted(
+      const std::vector<std::vector<ftk::critical_point_t<N, double>>>& trajs)
+  {
+    std::vector<ftk::critical_point_t<N, double>> cps;
+    for (const auto &traj : trajs)
+      cps.insert(cps.end(), traj.begin(), traj.end());
+    std::sort(cps.begin(), cps.end(),
+        [](const ftk::critical_point_t<N, double>& a, const ftk::critical_point_t<N, double>& b) {
+          return std::lexicographical_compare(a.x, a.x + N, b.x, b.x + N);
+        });
+    return cps;
+  }
+
+  template <int N>
+  static void expect_same(
+      const std::vector<ftk::critical_point_t<N, double>>& a,
+      const std::vector<ftk::critical_point_t<N, double>>& b)
+  {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); i ++) {
+      for (int j = 0; j < N; j ++)
+        EXPECT_NEAR(a[i].x[j], b[i].x[j], 1e-9);
+      EXPECT_NEAR(a[i].scalar, b[i].scalar, 1e-9);
+      EXPECT_EQ(a[i].type, b[i].type);
+    }
+  }
+
+  static std::vector<ftk::critical_point_2dt_t> track_2d(bool lazy)
+  {
+    const int DW = 32, DH = 32, DT = 6;
+    ftk::critical_point_tracker_2d_regular tracker;
+    tracker.set_domain(ftk::lattice({2, 2}, {DW-3, DH-3}));
+    tracker.set_array_domain(ftk::lattice({0, 0}, {DW, DH}));
+    tracker.set_input_array_partial(false);
+    tracker.set_scalar_field_source(ftk::SOURCE_GIVEN);
+    tracker.set_vector_field_source(ftk::SOURCE_DERIVED);
+    tracker.set_jacobian_field_source(ftk::SOURCE_DERIVED);
+    tracker.set_jacobian_symmetric(true);
+    tracker.set_jacobian_field_lazy(lazy);
+
+    std::vector<std::vector<ftk::critical_point_2dt_t>> trajs;
+    tracker.set_trajectory_callback([&](const std::vector<ftk::critical_point_2dt_t>& traj) {trajs.push_back(traj);});
+    tracker.initialize();
+    for (int k = 0; k < DT; k ++) {
+      tracker.push_scalar_field_snapshot(ftk::synthetic_woven_2D<double>(DW, DH, double(k) / (DT - 1)));
+      if (k == DT - 1) tracker.update_timestep();
+      else if (k != 0) tracker.advance_timestep();
+    }
+    tracker.finalize();
+    return sorted<3>(trajs);
+  }
+
+  static std::vector<ftk::critical_point_3dt_t> track_3d(bool lazy)
+  {
+    const int D = 12, DT = 3;
+    ftk::critical_point_tracker_3d_regular tracker;
+    tracker.set_domain(ftk::lattice({2, 2, 2}, {D-3, D-3, D-3}));
+    tracker.set_array_domain(ftk::lattice({0, 0, 0}, {D, D, D}));
+    tracker.set_input_array_partial(false);
+    tracker.set_scalar_field_source(ftk::SOURCE_GIVEN);
+    tracker.set_vector_field_source(ftk::SOURCE_DERIVED);
+    tracker.set_jacobian_field_source(ftk::SOURCE_DERIVED);
+    tracker.set_jacobian_symmetric(true);
+    tracker.set_jacobian_field_lazy(lazy);
+
+    std::vector<std::vector<ftk::critical_point_3dt_t>> trajs;
+    tracker.set_trajectory_callback([&](const std::vector<ftk::critical_point_3dt_t>& traj) {trajs.push_back(traj);});
+    tracker.initialize();
+    for (int k = 0; k < DT; k ++) {
+      ftk::ndarray<double> s({size_t(D), size_t(D), size_t(D)});
+      for (int z = 0; z < D; z ++)
+        for (int y = 0; y < D; y ++)
+          for (int x = 0; x < D; x ++)
+            s(x, y, z) = sin(0.5*x + 0.1*k) * cos(0.45*y) * sin(0.4*z + 0.3) + 0.01*x;
+      tracker.push_scalar_field_snapshot(s);
+      if (k == DT - 1) tracker.update_timestep();
+      else if (k != 0) tracker.advance_timestep();
+    }
+    tracker.finalize();
+    return sorted<4>(trajs);
+  }
+};
+
+TEST_F(critical_point_tracker_test, lazy_jacobian_2d) {
+  const auto cps = track_2d(true);
+  EXPECT_FALSE(cps.empty());
+  expect_same<3>(cps, track_2d(false));
+}
+
+TEST_F(critical_point_tracker_test, lazy_jacobian_3d) {
+  const auto cps = track_3d(true);
+  EXPECT_FALSE(cps.empty());
+  for (const auto &cp : cps) // classified from the interpolated hessian
+    EXPECT_NE(cp.type, ftk::CRITICAL_POINT_3D_UNKNOWN);
+  expect_same<4>(cps, track_3d(false));
+}
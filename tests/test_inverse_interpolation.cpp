@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <ftk/numeric/inverse_linear_interpolation_solver.hh>
+#include <ftk/numeric/inverse_linear_interpolation_solver_batch.hh>
 #include <ftk/numeric/linear_interpolation.hh>
 #include <ftk/numeric/rand.hh>
 #include <ftk/numeric/trilinear_interpolation.hh>
@@ -36,6 +37,34 @@ TEST_F(inverse_interpolation_test, inverse_linear_interpolation_3simplex_vector3
   }
 }
 
+TEST_F(inverse_interpolation_test, inverse_linear_interpolation_batch) {
+  const int W = 16;
+  double V2[3][2][W], mu2[3][W], V3[4][3][W], mu3[4][W];
+  int succ2[W], succ3[W];
+  for (int k = 0; k < W; k ++) {
+    double v2[3][2], v3[4][3];
+    ftk::rand3x2(v2);
+    ftk::rand4x3(v3);
+    for (int i = 0; i < 3; i ++) for (int j = 0; j < 2; j ++) V2[i][j][k] = v2[i][j];
+    for (int i = 0; i < 4; i ++) for (int j = 0; j < 3; j ++) V3[i][j][k] = v3[i][j];
+  }
+
+  // every path available on this processor matches the scalar solvers bitwise
+  for (int isa = ftk::SIMD_NONE; isa <= ftk::simd_isa(); isa ++) {
+    ftk::inverse_lerp_s2v2_batch<W>(V2, mu2, succ2, std::numeric_limits<double>::epsilon(), isa);
+    ftk::inverse_lerp_s3v3_batch<W>(V3, mu3, succ3, isa);
+    for (int k = 0; k < W; k ++) {
+      double v2[3][2], v3[4][3], m2[3], m3[4];
+      for (int i = 0; i < 3; i ++) for (int j = 0; j < 2; j ++) v2[i][j] = V2[i][j][k];
+      for (int i = 0; i < 4; i ++) for (int j = 0; j < 3; j ++) v3[i][j] = V3[i][j][k];
+      EXPECT_EQ(ftk::inverse_lerp_s2v2(v2, m2), bool(succ2[k]));
+      EXPECT_EQ(ftk::inverse_lerp_s3v3(v3, m3), bool(succ3[k]));
+      for (int i = 0; i < 3; i ++) EXPECT_EQ(m2[i], mu2[i][k]);
+      for (int i = 0; i < 4; i ++) EXPECT_EQ(m3[i], mu3[i][k]);
+    }
+  }
+}
+
 TEST_F(inverse_interpolation_test, trilinear_interpolation3) {
   double V[8][3];
   for (int run = 0; run < nruns; run ++) {
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <ftk/hypermesh/lattice_partitioner.hh>
+
+TEST(lattice_partitioner, weighted) {
+  const ftk::lattice l({2, 2}, {61, 45});
+  const size_t bin = 4, nx = (61 + bin - 1) / bin, ny = (45 + bin - 1) / bin;
+
+  // a hot spot of a few bins on top of a uniform cost
+  std::vector<double> cost(nx * ny, 1.0);
+  for (size_t y = 2; y < 4; y ++)
+    for (size_t x = 3; x < 6; x ++)
+      cost[x + y * nx] = 100.0;
+  const double total = std::accumulate(cost.begin(), cost.end(), 0.0);
+
+  auto block_cost = [&](const ftk::lattice& core) { // of the bins at the vertices
+    double c = 0;
+    for (size_t y = core.start(1); y < core.start(1) + core.size(1); y ++)
+      for (size_t x = core.start(0); x < core.start(0) + core.size(0); x ++)
+        if ((x - 2) % bin == 0 && (y - 2) % bin == 0)
+          c += cost[(x - 2) / bin + (y - 2) / bin * nx];
+    return c;
+  };
+
+  for (size_t np : {1, 2, 3, 5, 8}) {
+    ftk::lattice_partitioner partitioner(l);
+    partitioner.partition_weighted(np, cost, bin, {2, 2}, {3, 3});
+    ASSERT_EQ(partitioner.np(), np);
+
+    // the cores tile the lattice on bin boundaries
+    std::vector<int> covered(61 * 45, 0);
+    double max_cost = 0;
+    for (size_t p = 0; p < np; p ++) {
+      const auto &core = partitioner.get_core(p), &ext = partitioner.get_ext(p);
+      for (size_t y = core.start(1); y < core.start(1) + core.size(1); y ++)
+        for (size_t x = core.start(0); x < core.start(0) + core.size(0); x ++)
+          covered[(x - 2) + (y - 2) * 61] ++;
+      max_cost = std::max(max_cost, block_cost(core));
+
+      for (int i = 0; i < 2; i ++) {
+        EXPECT_EQ((core.start(i) - 2) % bin, 0);
+        EXPECT_EQ(ext.start(i), std::max(core.start(i) - 2, l.start(i)));
+        EXPECT_EQ(ext.start(i) + ext.size(i), 
+            std::min(core.start(i) + core.size(i) + 3, l.start(i) + l.size(i)));
+      }
+    }
+    for (auto c : covered)
+      EXPECT_EQ(c, 1);
+
+    // cuts are on bins, so that a block may exceed its share by hot bins
+    EXPECT_LE(max_cost, total / np + 200.0 * (np > 1));
+
+    // and the hottest block is cheaper than in the regular partition
+    ftk::lattice_partitioner regular(l);
+    regular.partition(np);
+    double max_regular_cost = 0;
+    for (size_t p = 0; p < regular.np(); p ++)
+      max_regular_cost = std::max(max_regular_cost, block_cost(regular.get_core(p)));
+    EXPECT_LE(max_cost, max_regular_cost);
+  }
+
+  // the number of bins bounds the number of blocks
+  ftk::lattice_partitioner partitioner(l);
+  partitioner.partition_weighted(nx * ny + 1, cost, bin, {}, {});
+  EXPECT_EQ(partitioner.np(), 0);
+}
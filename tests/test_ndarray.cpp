@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdio>
+#include <ftk/ndarray.hh>
+#include <ftk/ndarray/minmax_pyramid.hh>
+#include <ftk/ndarray/grad.hh>
+
+class ndarray_test : public testing::Test {
+public:
+  const std::string filename = "test_ndarray.bin";
+};
+
+TEST_F(ndarray_test, binary_file_mmap) {
+  const size_t n = 3000, nt = 3; // each timestep is not page-aligned
+  ftk::ndarray<float> a({n, nt});
+  for (size_t i = 0; i < a.nelem(); i ++)
+    a[i] = i;
+  a.to_binary_file(filename);
+
+  ftk::ndarray<float> b; // map the last timestep
+  b.from_binary_file_mmap(filename, {n}, (nt-1) * n * sizeof(float));
+  EXPECT_TRUE(b.is_mapped());
+  const ftk::ndarray<float> &cb = b; // reading does not copy the elements
+  for (size_t i = 0; i < n; i ++)
+    EXPECT_EQ(cb[i], a(i, nt-1));
+  EXPECT_TRUE(b.is_mapped());
+
+  ftk::ndarray<float> c(b); // copies share the mapping until written
+  EXPECT_TRUE(c.is_mapped());
+  EXPECT_EQ(c.view().data(), cb.data());
+  c[0] = -1;
+  EXPECT_FALSE(c.is_mapped());
+  EXPECT_EQ(c[0], -1);
+  EXPECT_EQ(c[1], a(1, nt-1));
+  EXPECT_TRUE(b.is_mapped());
+  EXPECT_EQ(cb[0], a(0, nt-1));
+
+  b[1] = -2; // also for the original array
+  EXPECT_FALSE(b.is_mapped());
+  EXPECT_EQ(b[1], -2);
+  EXPECT_EQ(c[1], a(1, nt-1));
+
+  ftk::ndarray<float> d;
+  d.from_binary_file_mmap(filename, {n, nt});
+  EXPECT_EQ(d(0, nt-1), a(0, nt-1));
+
+  d.reshape(n); // resizing copies the elements to owned storage
+  EXPECT_FALSE(d.is_mapped());
+  EXPECT_EQ(d[n-1], a[n-1]);
+
+  std::remove(filename.c_str());
+}
+
+TEST_F(ndarray_test, binary_file_block) {
+  ftk::ndarray<double> a;
+  a.reshape(2, 10, 7, 5);
+  for (size_t i = 0; i < a.nelem(); i ++)
+    a[i] = i;
+  a.to_binary_file(filename);
+
+  const ftk::lattice blocks[] = {
+    ftk::lattice({0, 3, 2, 1}, {2, 5, 4, 3}), // runs of rows
+    ftk::lattice({0, 0, 2, 1}, {2, 10, 4, 3}), // runs of slabs
+    ftk::lattice({1, 0, 0, 0}, {1, 10, 7, 5})
+  };
+  for (const auto &l : blocks) {
+    ftk::ndarray<double> b;
+    b.from_binary_file(filename, a.shape(), l);
+    const auto c = a.slice(l);
+    EXPECT_EQ(b.shape(), c.shape());
+    EXPECT_TRUE(std::equal(b.data(), b.data() + b.nelem(), c.data()));
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST_F(ndarray_test, minmax_pyramid) {
+  const size_t nc = 2, nx = 11, ny = 9; // not multiples of the brick size
+  ftk::ndarray<double> V({nc, nx, ny});
+  for (size_t j = 0; j < ny; j ++)
+    for (size_t i = 0; i < nx; i ++) {
+      V(0, i, j) = std::sin(0.7 * i + 0.3 * j);
+      V(1, i, j) = std::cos(0.2 * i * j);
+    }
+
+  ftk::minmax_pyramid<double> P;
+  P.build(V);
+  ASSERT_FALSE(P.empty());
+  EXPECT_EQ(P.ncells(0), nx - 1);
+  EXPECT_EQ(P.ncells(1), ny - 1);
+
+  // bricks bound the vertices of their cells, including the shared layer
+  const size_t B = P.block_size(0);
+  for (size_t j = 0; j < ny; j ++)
+    for (size_t i = 0; i < nx; i ++) {
+      const size_t bi = std::min(i / B, P.nblocks(0, 0) - 1), 
+                   bj = std::min(j / B, P.nblocks(0, 1) - 1);
+      for (size_t di = 0; di <= (i % B == 0 && i > 0 && i / B == bi); di ++)
+        for (size_t dj = 0; dj <= (j % B == 0 && j > 0 && j / B == bj); dj ++) {
+          const size_t b[2] = {bi - di, bj - dj};
+          const size_t idx = P.block_index(0, b);
+          for (size_t c = 0; c < nc; c ++) {
+            EXPECT_LE(P.lower(0, idx)[c], V(c, i, j));
+            EXPECT_GE(P.upper(0, idx)[c], V(c, i, j));
+          }
+        }
+    }
+
+  // the top level is a single block with the global bounds
+  const int top = P.nlevels() - 1;
+  EXPECT_EQ(P.nblocks(top, 0), size_t(1));
+  EXPECT_EQ(P.nblocks(top, 1), size_t(1));
+  for (size_t c = 0; c < nc; c ++) {
+    double lo = V(c, 0, 0), hi = lo;
+    for (size_t j = 0; j < ny; j ++)
+      for (size_t i = 0; i < nx; i ++) {
+        lo = std::min(lo, V(c, i, j));
+        hi = std::max(hi, V(c, i, j));
+      }
+    EXPECT_EQ(P.lower(top, 0)[c], lo);
+    EXPECT_EQ(P.upper(top, 0)[c], hi);
+  }
+}
+
+TEST_F(ndarray_test, jacobian_at_vertex) {
+  const int n = 9;
+  ftk::ndarray<double> V({3, size_t(n), size_t(n), size_t(n)});
+  for (size_t i = 0; i < V.nelem(); i ++)
+    V[i] = std::sin(0.37 * i);
+
+  const auto J = ftk::jacobian3D(V);
+  for (int k = 0; k < n; k ++)
+    for (int j = 0; j < n; j ++)
+      for (int i = 0; i < n; i ++) {
+        double Jv[3][3];
+        ftk::jacobian3D(V, i, j, k, Jv);
+        for (int a = 0; a < 3; a ++)
+          for (int b = 0; b < 3; b ++)
+            EXPECT_EQ(Jv[a][b], J(a, b, i, j, k));
+      }
+}
+
+TEST_F(ndarray_test, gradient_jacobian_fused) {
+  ftk::ndarray<float> s2({37, 23});
+  for (size_t i = 0; i < s2.nelem(); i ++)
+    s2[i] = std::sin(0.11 * i) * std::cos(0.05 * i);
+
+  ftk::ndarray<float> g2, J2; // tiles smaller than the field
+  ftk::gradient_jacobian2D(s2, g2, J2, 5);
+  EXPECT_EQ(g2.shape(), ftk::gradient2D(s2).shape());
+  EXPECT_TRUE(std::equal(g2.data(), g2.data() + g2.nelem(), ftk::gradient2D(s2).data()));
+  EXPECT_TRUE(std::equal(J2.data(), J2.data() + J2.nelem(), ftk::jacobian2D(ftk::gradient2D(s2)).data()));
+
+  ftk::ndarray<double> s3({11, 9, 13});
+  for (size_t i = 0; i < s3.nelem(); i ++)
+    s3[i] = std::sin(0.23 * i);
+
+  ftk::ndarray<double> g3, J3;
+  ftk::gradient_jacobian3D(s3, g3, J3, 3);
+  EXPECT_EQ(J3.shape(), ftk::jacobian3D(ftk::gradient3D(s3)).shape());
+  EXPECT_TRUE(std::equal(g3.data(), g3.data() + g3.nelem(), ftk::gradient3D(s3).data()));
+  EXPECT_TRUE(std::equal(J3.data(), J3.data() + J3.nelem(), ftk::jacobian3D(ftk::gradient3D(s3)).data()));
+
+  s3.reshape(11, 9, 12); // reused buffers are overwritten, including borders
+  for (size_t i = 0; i < s3.nelem(); i ++)
+    s3[i] = std::cos(0.31 * i);
+  ftk::gradient_jacobian3D(s3, g3, J3);
+  EXPECT_TRUE(std::equal(J3.data(), J3.data() + J3.nelem(), ftk::jacobian3D(ftk::gradient3D(s3)).data()));
+}
+
+TEST_F(ndarray_test, view) {
+  ftk::ndarray<double> a;
+  a.reshape(4, 5, 6);
+  for (size_t i = 0; i < a.nelem(); i ++)
+    a[i] = i;
+
+  // slices and transposes refer to the elements of the array
+  auto v = a.view().slice({1, 2, 0}, {3, 2, 6});
+  EXPECT_FALSE(v.contiguous());
+  EXPECT_EQ(v(2, 1, 5), a(3, 3, 5));
+
+  auto t = a.view().transpose({2, 0, 1});
+  EXPECT_EQ(t.shape(), std::vector<size_t>({6, 4, 5}));
+  EXPECT_EQ(t(5, 3, 4), a(3, 4, 5));
+
+  const auto b = a.slice({1, 2, 0}, {3, 2, 6}), 
+             c = a.transpose();
+  for (size_t k = 0; k < 6; k ++)
+    for (size_t j = 0; j < 2; j ++)
+      for (size_t i = 0; i < 3; i ++) {
+        EXPECT_EQ(b(i, j, k), a(i+1, j+2, k));
+        EXPECT_EQ(c(k, j, i), a(i, j, k));
+      }
+
+  // contiguous time slices are aliased and others are copied
+  const auto s = ftk::ndarray<double>::alias(a.view().slice_time(3));
+  EXPECT_EQ(s.data(), &a(0, 0, 3));
+  EXPECT_EQ(s.shape(), std::vector<size_t>({4, 5}));
+  const auto s1 = s; // copies share the elements
+  EXPECT_EQ(s1.data(), s.data());
+
+  const double a0 = a(0, 0, 3);
+  auto s2 = s; // and copy them before they are written
+  s2(0, 0) = a0 - 1;
+  EXPECT_NE(s2.view().data(), s.data());
+  EXPECT_EQ(a(0, 0, 3), a0);
+  EXPECT_EQ(s(0, 0), a0);
+  EXPECT_EQ(s2(1, 0), a(1, 0, 3));
+
+  auto u = ftk::ndarray<double>::alias(v.slice_time(3));
+  EXPECT_NE(u.data(), &a(1, 2, 3));
+  EXPECT_EQ(u(2, 1), a(3, 3, 3));
+
+  ftk::ndarray<double> g0 = ftk::gradient2D(a.slice_time(3)), 
+                       g1 = ftk::gradient2D(a.view().slice_time(3));
+  EXPECT_EQ(g0.shape(), g1.shape());
+  for (size_t i = 0; i < g0.nelem(); i ++)
+    EXPECT_EQ(g0[i], g1[i]);
+}
+
+TEST_F(ndarray_test, fixed_rank) {
+  ftk::ndarray<float> a;
+  a.reshape(2, 7, 5);
+  for (size_t i = 0; i < a.nelem(); i ++)
+    a[i] = i;
+
+  const auto &ca = a;
+  auto f = ca.fixed<3>();
+  EXPECT_EQ(f.data(), a.data()); // no copies
+  EXPECT_EQ(f.nelem(), a.nelem());
+  for (size_t k = 0; k < 5; k ++)
+    for (size_t j = 0; j < 7; j ++)
+      for (size_t i = 0; i < 2; i ++) {
+        EXPECT_EQ(f(i, j, k), a(i, j, k));
+        EXPECT_EQ(f.index({i, j, k}), a.index(std::vector<size_t>({i, j, k})));
+      }
+
+  a.fixed<3>()(1, 6, 4) = -1.f;
+  EXPECT_EQ(a(1, 6, 4), -1.f);
+}
+
+TEST_F(ndarray_test, derivatives_of_blocks) {
+  ftk::ndarray<double> s;
+  s.reshape(24, 20);
+  for (size_t i = 0; i < s.nelem(); i ++)
+    s[i] = std::sin(0.1 * i);
+
+  // derivatives of a block are scaled by the sizes of the whole array
+  const ftk::lattice l({5, 4}, {12, 10});
+  ftk::ndarray<double> g, J, g0, J0;
+  ftk::gradient_jacobian2D(s, g0, J0);
+  ftk::gradient_jacobian2D(s.slice(l), g, J, 16, 24, 20);
+  for (size_t y = 2; y < 8; y ++)
+    for (size_t x = 2; x < 10; x ++) {
+      EXPECT_EQ(g(0, x, y), g0(0, x+5, y+4));
+      EXPECT_EQ(J(1, 0, x, y), J0(1, 0, x+5, y+4));
+    }
+}
+
+TEST_F(ndarray_test, derivatives_in_reused_buffers) {
+  ftk::ndarray<double> s;
+  s.reshape(9, 8, 7);
+  for (size_t i = 0; i < s.nelem(); i ++)
+    s[i] = std::sin(0.3 * i);
+
+  ftk::ndarray<double> g, J;
+  g.reshape(std::vector<size_t>({3, 9, 8, 7}), 42.0); // stale values
+  J.reshape(std::vector<size_t>({3, 3, 9, 8, 7}), 42.0);
+  ftk::gradient3D(s, g);
+  ftk::jacobian3D(g, J);
+
+  const auto g0 = ftk::gradient3D(s), J0 = ftk::jacobian3D(g0);
+  for (size_t i = 0; i < g0.nelem(); i ++)
+    EXPECT_EQ(g[i], g0[i]);
+  for (size_t i = 0; i < J0.nelem(); i ++)
+    EXPECT_EQ(J[i], J0[i]);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <ftk/hypermesh/regular_simplex_mesh.hh>
+
+// the precomputed tables must agree with the runtime enumeration
+template <int ND>
+void check_unit_simplex_table()
+{
+  typedef ftk::unit_simplex_table<ND> table;
+  ftk::regular_simplex_mesh m(ND);
+  const ftk::lattice l(std::vector<size_t>(ND, 0), std::vector<size_t>(ND, 1)); // a single cube
+
+  for (int d = 0; d <= ND; d ++) {
+    for (int scope = ftk::ELEMENT_SCOPE_ALL; scope <= ftk::ELEMENT_SCOPE_INTERVAL; scope ++) {
+      ASSERT_EQ(table::ntypes(d, scope), m.ntypes(d, scope));
+      for (int i = 0; i < m.ntypes(d, scope); i ++) {
+        ftk::regular_simplex_mesh_element e(m, d, i, l, scope);
+        EXPECT_EQ(table::scoped_type(d, scope, i), e.type);
+      }
+    }
+
+    for (int t = 0; t < m.ntypes(d); t ++) {
+      const auto vertices = m.unit_simplex(d, t);
+      const int *offsets = table::offsets(d, t);
+      for (int i = 0; i <= d; i ++)
+        for (int j = 0; j < ND; j ++)
+          EXPECT_EQ(offsets[i*ND + j], vertices[i][j]);
+
+      const ftk::regular_simplex_mesh_element e(std::vector<int>(ND, 0), d, t);
+
+      const auto sides = e.sides(m);
+      ASSERT_EQ(table::nsides(d), sides.size());
+      const int *s = table::sides(d, t);
+      for (const auto &side : sides) {
+        EXPECT_EQ(s[0], side.type);
+        for (int j = 0; j < ND; j ++)
+          EXPECT_EQ(s[j+1], side.corner[j]);
+        s += ND+1;
+      }
+
+      const auto side_of = e.side_of(m);
+      ASSERT_EQ(table::nside_of(d, t), side_of.size());
+      s = table::side_of(d, t);
+      for (const auto &c : side_of) {
+        EXPECT_EQ(s[0], c.type);
+        for (int j = 0; j < ND; j ++)
+          EXPECT_EQ(s[j+1], c.corner[j]);
+        s += ND+1;
+      }
+    }
+  }
+}
+
+TEST(regular_simplex_mesh_test, unit_simplex_tables) {
+  check_unit_simplex_table<1>();
+  check_unit_simplex_table<2>();
+  check_unit_simplex_table<3>();
+  check_unit_simplex_table<4>();
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <ftk/basic/union_find.hh>
 #include <ftk/basic/simple_union_find.hh>
+#include <ftk/geometry/cc2curves.hh>
 #include <string>
 
 class union_find_test : public testing::Test {
@@ -42,3 +43,26 @@ TEST_F(union_find_test, simple_union_find) {
   EXPECT_TRUE(!UF.same_set(0, 1));
   EXPECT_TRUE(!UF.same_set(1, 5));
 }
+
+// test connected components on a graph in the CSR format
+TEST_F(union_find_test, csr_connected_components) {
+  // 0-1-2 is a path, 3 is isolated, and 4-5-6-4 is a cycle
+  const std::vector<std::vector<size_t>> adj = {{1}, {0, 2}, {1}, {}, {5, 6}, {4, 6}, {4, 5}};
+  ftk::csr_graph<size_t> g;
+  for (auto neighbors : adj)
+    g.add_node(neighbors);
+
+  auto components = ftk::extract_connected_components(g);
+  ASSERT_EQ(components.size(), 3);
+  EXPECT_EQ(components[0], std::vector<size_t>({0, 1, 2}));
+  EXPECT_EQ(components[1], std::vector<size_t>({3}));
+  EXPECT_EQ(components[2], std::vector<size_t>({4, 5, 6}));
+
+  auto path = ftk::connected_component_to_linear_components(components[0], g);
+  ASSERT_EQ(path.size(), 1);
+  EXPECT_EQ(path[0], std::vector<size_t>({0, 1, 2}));
+
+  auto cycle = ftk::connected_component_to_linear_components(components[2], g);
+  ASSERT_EQ(cycle.size(), 1);
+  EXPECT_EQ(cycle[0].size(), 3);
+}